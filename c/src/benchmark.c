@@ -1,5 +1,6 @@
 #define _POSIX_C_SOURCE 199309L
 #include "benchmark.h"
+#include "kernels.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -13,22 +14,6 @@ static int64_t get_time_ns(void) {
     return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
 }
 
-// 比較関数（qsort用）
-static int compare_ints(const void* a, const void* b) {
-    int ia = *(const int*)a;
-    int ib = *(const int*)b;
-    return (ia > ib) - (ia < ib);
-}
-
-// 簡単なハッシュ関数
-static uint32_t simple_hash(const char* data, size_t len) {
-    uint32_t hash = 5381;
-    for (size_t i = 0; i < len; i++) {
-        hash = ((hash << 5) + hash) + (unsigned char)data[i];
-    }
-    return hash;
-}
-
 int run_all_benchmarks(BenchmarkResult* results, int max_results) {
     int count = 0;
     
@@ -49,13 +34,8 @@ int run_all_benchmarks(BenchmarkResult* results, int max_results) {
 BenchmarkResult benchmark_prime_numbers(void) {
     int64_t start = get_time_ns();
     
-    int count = 0;
     const int limit = 100000;
-    for (int i = 2; i <= limit; i++) {
-        if (is_prime(i)) {
-            count++;
-        }
-    }
+    int count = count_primes(limit);
     
     int64_t duration = get_time_ns() - start;
     double duration_seconds = duration / 1e9;
@@ -70,14 +50,6 @@ BenchmarkResult benchmark_prime_numbers(void) {
     return result;
 }
 
-int is_prime(int n) {
-    if (n < 2) return 0;
-    for (int i = 2; i <= (int)sqrt(n); i++) {
-        if (n % i == 0) return 0;
-    }
-    return 1;
-}
-
 BenchmarkResult benchmark_matrix_multiplication(void) {
     int64_t start = get_time_ns();
     
@@ -104,13 +76,7 @@ BenchmarkResult benchmark_matrix_multiplication(void) {
     }
     
     // 行列乗算
-    for (int i = 0; i < size; i++) {
-        for (int j = 0; j < size; j++) {
-            for (int k = 0; k < size; k++) {
-                c[i][j] += a[i][k] * b[k][j];
-            }
-        }
-    }
+    multiply_matrices(a, b, c, size);
     
     // メモリ解放
     for (int i = 0; i < size; i++) {
@@ -146,12 +112,7 @@ BenchmarkResult benchmark_hash_computing(void) {
     }
     
     const int iterations = 50000;
-    uint32_t hash_sum = 0;
-    
-    for (int i = 0; i < iterations; i++) {
-        uint32_t hash = simple_hash(data, 1024);
-        hash_sum += hash; // 最適化を防ぐ
-    }
+    uint32_t hash_sum = hash_repeated(data, 1024, iterations);
     
     // hash_sumを使用して最適化を防ぐ
     if (hash_sum == 0) {
@@ -177,11 +138,7 @@ BenchmarkResult benchmark_math_operations(void) {
     int64_t start = get_time_ns();
     
     const int iterations = 10000000;
-    double result = 0.0;
-    for (int i = 0; i < iterations; i++) {
-        double x = (double)i;
-        result += sin(x) * cos(x) * sqrt(x + 1);
-    }
+    double result = math_operations(iterations);
     
     int64_t duration = get_time_ns() - start;
     double duration_seconds = duration / 1e9;
@@ -212,7 +169,7 @@ BenchmarkResult benchmark_large_array_sort(void) {
         data[i] = rand() % 1000001;
     }
     
-    qsort(data, size, sizeof(int), compare_ints);
+    sort_ints(data, size);
     
     free(data);
     
@@ -233,20 +190,12 @@ BenchmarkResult benchmark_memory_allocation(void) {
     int64_t start = get_time_ns();
     
     const int allocations = 100000;
-    int** arrays = malloc(allocations * sizeof(int*));
+    int64_t checksum = allocate_arrays(allocations);
     
-    for (int i = 0; i < allocations; i++) {
-        arrays[i] = malloc(256 * sizeof(int)); // 1KB相当のデータ
-        for (int j = 0; j < 256; j++) {
-            arrays[i][j] = i % 256;
-        }
-    }
-    
-    // メモリ解放
-    for (int i = 0; i < allocations; i++) {
-        free(arrays[i]);
+    // checksumを使用して最適化を防ぐ
+    if (checksum < 0) {
+        printf("Unexpected negative checksum\n");
     }
-    free(arrays);
     
     int64_t duration = get_time_ns() - start;
     double duration_seconds = duration / 1e9;
@@ -265,17 +214,11 @@ BenchmarkResult benchmark_string_concatenation(void) {
     int64_t start = get_time_ns();
     
     const int iterations = 50000;
-    size_t buffer_size = iterations * 20; // 十分なサイズを確保
-    char* result = malloc(buffer_size);
-    result[0] = '\0';
-    
-    for (int i = 0; i < iterations; i++) {
-        char temp[32];
-        snprintf(temp, sizeof(temp), "iteration_%d_", i);
-        strncat(result, temp, buffer_size - strlen(result) - 1);
-    }
+    size_t length = concatenate_strings(iterations);
     
-    free(result);
+    if (length == 0) {
+        printf("Unexpected empty string\n");
+    }
     
     int64_t duration = get_time_ns() - start;
     double duration_seconds = duration / 1e9;
@@ -21,6 +21,4 @@ BenchmarkResult benchmark_large_array_sort(void);
 BenchmarkResult benchmark_memory_allocation(void);
 BenchmarkResult benchmark_string_concatenation(void);
 
-int is_prime(int n);
-
 #endif
\ No newline at end of file
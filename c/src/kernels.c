@@ -0,0 +1,107 @@
+#include "kernels.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// 比較関数（qsort用）
+static int compare_ints(const void* a, const void* b) {
+    int ia = *(const int*)a;
+    int ib = *(const int*)b;
+    return (ia > ib) - (ia < ib);
+}
+
+int is_prime(int n) {
+    if (n < 2) return 0;
+    for (int i = 2; i <= (int)sqrt(n); i++) {
+        if (n % i == 0) return 0;
+    }
+    return 1;
+}
+
+int count_primes(int limit) {
+    int count = 0;
+    for (int i = 2; i <= limit; i++) {
+        if (is_prime(i)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void multiply_matrices(double** a, double** b, double** c, int size) {
+    for (int i = 0; i < size; i++) {
+        for (int j = 0; j < size; j++) {
+            for (int k = 0; k < size; k++) {
+                c[i][j] += a[i][k] * b[k][j];
+            }
+        }
+    }
+}
+
+// 簡単なハッシュ関数（djb2）
+uint32_t simple_hash(const char* data, size_t len) {
+    uint32_t hash = 5381;
+    for (size_t i = 0; i < len; i++) {
+        hash = ((hash << 5) + hash) + (unsigned char)data[i];
+    }
+    return hash;
+}
+
+uint32_t hash_repeated(const char* data, size_t len, int iterations) {
+    uint32_t hash_sum = 0;
+    for (int i = 0; i < iterations; i++) {
+        hash_sum += simple_hash(data, len); // 最適化を防ぐ
+    }
+    return hash_sum;
+}
+
+double math_operations(int iterations) {
+    double result = 0.0;
+    for (int i = 0; i < iterations; i++) {
+        double x = (double)i;
+        result += sin(x) * cos(x) * sqrt(x + 1);
+    }
+    return result;
+}
+
+void sort_ints(int* data, size_t count) {
+    qsort(data, count, sizeof(int), compare_ints);
+}
+
+int64_t allocate_arrays(int allocations) {
+    int** arrays = malloc(allocations * sizeof(int*));
+    int64_t checksum = 0;
+    
+    for (int i = 0; i < allocations; i++) {
+        arrays[i] = malloc(256 * sizeof(int)); // 1KB相当のデータ
+        for (int j = 0; j < 256; j++) {
+            arrays[i][j] = i % 256;
+        }
+    }
+    
+    // メモリ解放
+    for (int i = 0; i < allocations; i++) {
+        checksum += arrays[i][255];
+        free(arrays[i]);
+    }
+    free(arrays);
+    
+    return checksum;
+}
+
+size_t concatenate_strings(int iterations) {
+    size_t buffer_size = iterations * 20; // 十分なサイズを確保
+    char* result = malloc(buffer_size);
+    result[0] = '\0';
+    
+    for (int i = 0; i < iterations; i++) {
+        char temp[32];
+        snprintf(temp, sizeof(temp), "iteration_%d_", i);
+        strncat(result, temp, buffer_size - strlen(result) - 1);
+    }
+    
+    size_t length = strlen(result);
+    free(result);
+    return length;
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 計測対象の処理本体。入力の生成と時間計測は呼び出し側で行う
+// （C++ハーネスからも extern "C" で同じ入力を渡して呼び出す）
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int is_prime(int n);
+int count_primes(int limit);
+void multiply_matrices(double** a, double** b, double** c, int size);
+uint32_t simple_hash(const char* data, size_t len);
+uint32_t hash_repeated(const char* data, size_t len, int iterations);
+double math_operations(int iterations);
+void sort_ints(int* data, size_t count);
+int64_t allocate_arrays(int allocations);
+size_t concatenate_strings(int iterations);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
\ No newline at end of file
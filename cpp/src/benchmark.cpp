@@ -2,28 +2,67 @@
 #include <iostream>
 #include <chrono>
 #include <cmath>
+#include <cstdlib>
 #include <algorithm>
 #include <random>
 #include <sstream>
 #include <iomanip>
 
-std::vector<BenchmarkResult> Benchmark::runAllBenchmarks() {
+const std::vector<BenchmarkCase>& Benchmark::registeredBenchmarks() {
+    static const std::vector<BenchmarkCase> cases = {
+        {"prime", "CPU-intensive", benchmarkPrimeNumbers},
+        {"matrix", "CPU-intensive", benchmarkMatrixMultiplication},
+        {"hash", "CPU-intensive", benchmarkCryptographicHashing},
+        {"math", "CPU-intensive", benchmarkMathOperations},
+        {"sort", "memory-intensive", benchmarkLargeArraySort},
+        {"alloc", "memory-intensive", benchmarkMemoryAllocation},
+        {"string", "memory-intensive", benchmarkStringConcatenation},
+    };
+    return cases;
+}
+
+std::vector<BenchmarkResult> Benchmark::runAllBenchmarks(const Runner& runner) {
+    return runBenchmarks(registeredBenchmarks(), runner);
+}
+
+std::vector<BenchmarkResult> Benchmark::runBenchmarks(const std::vector<BenchmarkCase>& cases,
+                                                      const Runner& runner) {
     std::vector<BenchmarkResult> results;
     
-    std::cout << "Running CPU-intensive benchmarks..." << std::endl;
-    results.push_back(benchmarkPrimeNumbers());
-    results.push_back(benchmarkMatrixMultiplication());
-    results.push_back(benchmarkCryptographicHashing());
-    results.push_back(benchmarkMathOperations());
-    
-    std::cout << "Running memory-intensive benchmarks..." << std::endl;
-    results.push_back(benchmarkLargeArraySort());
-    results.push_back(benchmarkMemoryAllocation());
-    results.push_back(benchmarkStringConcatenation());
+    std::string category;
+    for (const auto& benchmarkCase : cases) {
+        if (benchmarkCase.category != category) {
+            category = benchmarkCase.category;
+            std::cout << "Running " << category << " benchmarks..." << std::endl;
+        }
+        results.push_back(runner ? runner(benchmarkCase) : benchmarkCase.run());
+    }
     
     return results;
 }
 
+std::vector<size_t> Benchmark::sizesFromEnv(const char* name, const std::vector<size_t>& fallback) {
+    const char* value = std::getenv(name);
+    if (value == nullptr) {
+        return fallback;
+    }
+    std::vector<size_t> sizes;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        // 数字以外や size_t に収まらない桁数は std::stoull が投げるので先に弾く
+        if (item.empty()) {
+            continue;
+        }
+        if (item.size() > 18 || item.find_first_not_of("0123456789") != std::string::npos) {
+            std::cerr << "Ignoring invalid " << name << " entry '" << item << "'" << std::endl;
+            continue;
+        }
+        sizes.push_back(std::stoull(item));
+    }
+    return sizes.empty() ? fallback : sizes;
+}
+
 BenchmarkResult Benchmark::benchmarkPrimeNumbers() {
     auto start = std::chrono::high_resolution_clock::now();
     
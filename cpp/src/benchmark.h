@@ -1,14 +1,26 @@
 #pragma once
 
+#include <functional>
 #include <string>
+#include <utility>
 #include <vector>
 
+struct HotFunction {
+    std::string function;
+    long long samples;
+    double percent;
+};
+
 struct BenchmarkResult {
     std::string test;
     long long duration_ns;
     long long memory_bytes;
     long long operations;
     double ops_per_sec;
+    // 追加の指標（ns/switch など）。JSONでは "metrics" に出力される
+    std::vector<std::pair<std::string, double>> metrics;
+    // --profile 時のみ設定される（自己時間の多い順）
+    std::vector<HotFunction> hotFunctions;
     
     BenchmarkResult(const std::string& test, long long duration_ns, long long memory_bytes, 
                    long long operations, double ops_per_sec)
@@ -16,9 +28,23 @@ struct BenchmarkResult {
           operations(operations), ops_per_sec(ops_per_sec) {}
 };
 
+struct BenchmarkCase {
+    std::string id;
+    std::string category;
+    std::function<BenchmarkResult()> run;
+};
+
 class Benchmark {
 public:
-    static std::vector<BenchmarkResult> runAllBenchmarks();
+    // 各ベンチマークの実行を差し替える（プロファイル取得など）
+    using Runner = std::function<BenchmarkResult(const BenchmarkCase&)>;
+
+    static const std::vector<BenchmarkCase>& registeredBenchmarks();
+    static std::vector<BenchmarkResult> runAllBenchmarks(const Runner& runner = nullptr);
+    static std::vector<BenchmarkResult> runBenchmarks(const std::vector<BenchmarkCase>& cases,
+                                                      const Runner& runner = nullptr);
+    // "16,20" のようなカンマ区切りの環境変数を読む。未設定なら fallback
+    static std::vector<size_t> sizesFromEnv(const char* name, const std::vector<size_t>& fallback);
     
 private:
     static BenchmarkResult benchmarkPrimeNumbers();
@@ -0,0 +1,329 @@
+#include "contention.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+// 追加した1インスタンスあたりの総スループット増分がソロの半分を切ったら飽和とみなす
+const double kSaturationMarginalGain = 0.5;
+
+// fork した子からパイプでそのまま送れるよう固定長にしている
+struct InstanceSample {
+    long long durationNs;
+    long long operations;
+    char test[128];
+};
+
+InstanceSample toSample(const BenchmarkResult& result) {
+    InstanceSample sample{result.duration_ns, result.operations, {}};
+    result.test.copy(sample.test, sizeof(sample.test) - 1);
+    return sample;
+}
+
+int readSysfsInt(const std::string& path, int fallback) {
+    std::ifstream file(path);
+    int value = fallback;
+    if (!(file >> value)) {
+        return fallback;
+    }
+    return value;
+}
+
+// ピン留め先のCPU順序。cores は各物理コアの1番目のSMTを先に並べる
+std::vector<int> pinOrder(PinPolicy pin) {
+    std::vector<int> cpus;
+#ifdef __linux__
+    if (pin == PinPolicy::None) {
+        return cpus;
+    }
+
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return cpus;
+    }
+
+    std::map<std::pair<int, int>, std::vector<int>> cores;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed)) {
+            continue;
+        }
+        std::string topology = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+        int package = readSysfsInt(topology + "physical_package_id", 0);
+        int core = readSysfsInt(topology + "core_id", cpu);
+        cores[{package, core}].push_back(cpu);
+    }
+
+    if (pin == PinPolicy::Smt) {
+        for (const auto& core : cores) {
+            cpus.insert(cpus.end(), core.second.begin(), core.second.end());
+        }
+    } else {
+        for (size_t sibling = 0; cpus.size() < static_cast<size_t>(CPU_COUNT(&allowed)); sibling++) {
+            for (const auto& core : cores) {
+                if (sibling < core.second.size()) {
+                    cpus.push_back(core.second[sibling]);
+                }
+            }
+        }
+    }
+#else
+    if (pin != PinPolicy::None) {
+        std::cerr << "CPU pinning is only supported on Linux; running unpinned" << std::endl;
+    }
+#endif
+    return cpus;
+}
+
+void pinCurrentThread(const std::vector<int>& cpus, int instance) {
+#ifdef __linux__
+    if (cpus.empty()) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus[instance % cpus.size()], &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpus;
+    (void)instance;
+#endif
+}
+
+std::vector<InstanceSample> runThreads(const BenchmarkCase& benchmarkCase, int instances,
+                                       const std::vector<int>& cpus, long long& wallNs) {
+    std::vector<InstanceSample> samples(instances);
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < instances; i++) {
+        threads.emplace_back([&, i]() {
+            pinCurrentThread(cpus, i);
+            ready++;
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            samples[i] = toSample(benchmarkCase.run());
+        });
+    }
+
+    while (ready.load() < instances) {
+        std::this_thread::yield();
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    go.store(true);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    return samples;
+}
+
+std::vector<InstanceSample> runProcesses(const BenchmarkCase& benchmarkCase, int instances,
+                                         const std::vector<int>& cpus, long long& wallNs) {
+    std::vector<InstanceSample> samples(instances, InstanceSample{-1, 0, {}});
+    int startPipe[2];
+    if (pipe(startPipe) != 0) {
+        throw std::runtime_error("Could not create start pipe");
+    }
+
+    // 子プロセスで親のバッファが二重に出力されないようにする
+    std::cout.flush();
+
+    std::vector<std::pair<pid_t, int>> children;
+    // 途中で失敗したら、開始前に待機している子を止めて回収し、fd を閉じてから投げる
+    auto fail = [&](const std::string& message) {
+        close(startPipe[0]);
+        close(startPipe[1]);
+        for (const auto& child : children) {
+            kill(child.first, SIGKILL);
+            close(child.second);
+            waitpid(child.first, nullptr, 0);
+        }
+        throw std::runtime_error(message);
+    };
+
+    for (int i = 0; i < instances; i++) {
+        int resultPipe[2];
+        if (pipe(resultPipe) != 0) {
+            fail("Could not create result pipe for instance " + std::to_string(i + 1) + " of " +
+                 std::to_string(instances));
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(resultPipe[0]);
+            close(resultPipe[1]);
+            fail("Could not fork benchmark instance " + std::to_string(i + 1) + " of " +
+                 std::to_string(instances));
+        }
+        if (pid == 0) {
+            close(startPipe[1]);
+            close(resultPipe[0]);
+            pinCurrentThread(cpus, i);
+            char token;
+            if (read(startPipe[0], &token, 1) != 1) {
+                _exit(1);
+            }
+            InstanceSample sample = toSample(benchmarkCase.run());
+            ssize_t written = write(resultPipe[1], &sample, sizeof(sample));
+            std::cout.flush();
+            _exit(written == static_cast<ssize_t>(sizeof(sample)) ? 0 : 1);
+        }
+        close(resultPipe[1]);
+        children.emplace_back(pid, resultPipe[0]);
+    }
+    close(startPipe[0]);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::string tokens(instances, 'x');
+    ssize_t released = write(startPipe[1], tokens.data(), tokens.size());
+    close(startPipe[1]);
+    for (int i = 0; i < instances; i++) {
+        InstanceSample sample{-1, 0, {}};
+        if (released == instances && read(children[i].second, &sample, sizeof(sample)) == sizeof(sample)) {
+            samples[i] = sample;
+        }
+        close(children[i].second);
+        waitpid(children[i].first, nullptr, 0);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    for (const auto& sample : samples) {
+        if (sample.durationNs < 0) {
+            throw std::runtime_error("Benchmark instance failed: " + benchmarkCase.id);
+        }
+    }
+    return samples;
+}
+
+// 1, 2, 4, ... maxInstances。使える CPU 数を超える場合はその境目も測る
+std::vector<int> instanceCounts(int maxInstances, int usableCpus) {
+    std::vector<int> counts;
+    for (int k = 1; k < maxInstances; k *= 2) {
+        counts.push_back(k);
+    }
+    counts.push_back(maxInstances);
+    if (usableCpus < maxInstances && std::find(counts.begin(), counts.end(), usableCpus) == counts.end()) {
+        counts.insert(std::upper_bound(counts.begin(), counts.end(), usableCpus), usableCpus);
+    }
+    return counts;
+}
+
+}
+
+int Contention::usableCpus() {
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        return std::max(1, CPU_COUNT(&allowed));
+    }
+#endif
+    return static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+std::vector<BenchmarkResult> Contention::run(const std::vector<BenchmarkCase>& cases,
+                                             const ContentionOptions& options) {
+    std::vector<int> cpus = pinOrder(options.pin);
+    std::vector<BenchmarkResult> results;
+    if (options.maxInstances > usableCpus()) {
+        std::cout << "Note: only " << usableCpus() << " CPUs are usable; K > " << usableCpus()
+                  << " measures oversubscription and is excluded from saturation_k" << std::endl;
+    }
+    for (const auto& benchmarkCase : cases) {
+        std::cout << "Running " << benchmarkCase.id << " with up to " << options.maxInstances
+                  << " instances..." << std::endl;
+        auto caseResults = sweep(benchmarkCase, options, cpus);
+        results.insert(results.end(), caseResults.begin(), caseResults.end());
+    }
+    return results;
+}
+
+std::vector<BenchmarkResult> Contention::sweep(const BenchmarkCase& benchmarkCase,
+                                               const ContentionOptions& options,
+                                               const std::vector<int>& cpus) {
+    std::vector<BenchmarkResult> results;
+    std::vector<std::pair<int, double>> aggregates;
+    const int cpuCount = usableCpus();
+    double soloNs = 0.0;
+    double soloOpsPerSec = 0.0;
+    std::string testName = benchmarkCase.id;
+
+    // ソロ計測がコールドキャッシュ・初回ページフォールトの影響を受けないよう1回空回しする
+    benchmarkCase.run();
+
+    for (int instances : instanceCounts(options.maxInstances, cpuCount)) {
+        long long wallNs = 0;
+        std::vector<InstanceSample> samples = options.mode == InstanceMode::Process
+            ? runProcesses(benchmarkCase, instances, cpus, wallNs)
+            : runThreads(benchmarkCase, instances, cpus, wallNs);
+
+        long long totalOperations = 0;
+        double meanNs = 0.0;
+        double maxNs = 0.0;
+        for (const auto& sample : samples) {
+            totalOperations += sample.operations;
+            meanNs += static_cast<double>(sample.durationNs) / instances;
+            maxNs = std::max(maxNs, static_cast<double>(sample.durationNs));
+        }
+        // 各インスタンスの ops はベンチマーク自身の計測区間、総スループットは壁時計で割る
+        double aggregateOpsPerSec = totalOperations / (wallNs / 1e9);
+        if (instances == 1) {
+            // slowdown は計測区間どうし、効率と飽和点は壁時計どうしで比べる
+            soloNs = meanNs;
+            soloOpsPerSec = aggregateOpsPerSec;
+            testName = samples[0].test;
+        }
+        if (instances <= cpuCount) {
+            aggregates.emplace_back(instances, aggregateOpsPerSec);
+        }
+
+        BenchmarkResult result(testName + " x" + std::to_string(instances),
+                               wallNs, 0, totalOperations, aggregateOpsPerSec);
+        result.metrics = {
+            {"instances", static_cast<double>(instances)},
+            {"mean_instance_ns", meanNs},
+            {"slowdown", meanNs / soloNs},
+            {"max_slowdown", maxNs / soloNs},
+            {"scaling_efficiency", aggregateOpsPerSec / (soloOpsPerSec * instances)},
+            {"usable_cpus", static_cast<double>(cpuCount)},
+            {"oversubscribed", instances > cpuCount ? 1.0 : 0.0},
+        };
+        results.push_back(result);
+    }
+
+    // 飽和点: 追加インスタンスあたりの増分がソロのスループットの半分を下回った最初の K（0 は未飽和）。
+    // CPU 数を超える K は時分割で遅くなるだけなので対象にしない
+    int saturationK = 0;
+    for (size_t i = 1; i < aggregates.size(); i++) {
+        double added = aggregates[i].first - aggregates[i - 1].first;
+        double marginal = (aggregates[i].second - aggregates[i - 1].second) / added / soloOpsPerSec;
+        if (marginal < kSaturationMarginalGain) {
+            saturationK = aggregates[i].first;
+            break;
+        }
+    }
+    for (auto& result : results) {
+        result.metrics.push_back({"saturation_k", static_cast<double>(saturationK)});
+    }
+    return results;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "benchmark.h"
+#include <vector>
+
+enum class InstanceMode {
+    Thread,
+    Process,
+};
+
+enum class PinPolicy {
+    None,
+    Cores,  // 物理コアに1つずつ広げてから SMT 兄弟を使う
+    Smt,    // 同じ物理コアの SMT 兄弟から詰める
+};
+
+struct ContentionOptions {
+    int maxInstances = 1;
+    InstanceMode mode = InstanceMode::Thread;
+    PinPolicy pin = PinPolicy::None;
+};
+
+// 同じベンチマークを K 個同時に走らせ、共有資源（メモリ帯域・LLC）の競合を測る。
+// K = 1, 2, 4, ... maxInstances を順に実行し、K ごとに1レコードを返す
+class Contention {
+public:
+    // sched_getaffinity で使える CPU 数（取れなければ hardware_concurrency）
+    static int usableCpus();
+
+    static std::vector<BenchmarkResult> run(const std::vector<BenchmarkCase>& cases,
+                                            const ContentionOptions& options);
+
+private:
+    static std::vector<BenchmarkResult> sweep(const BenchmarkCase& benchmarkCase,
+                                              const ContentionOptions& options,
+                                              const std::vector<int>& cpus);
+};
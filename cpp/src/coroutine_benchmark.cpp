@@ -0,0 +1,460 @@
+#include "coroutine_benchmark.h"
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace {
+
+// フレーム確保の計測用カウンタ
+struct AllocStats {
+    long long frames = 0;    // promise_type::operator new の呼び出し回数
+    long long upstream = 0;  // ::operator new まで到達した確保回数
+    std::size_t lastFrameSize = 0;
+};
+
+struct DefaultFrameAllocator {
+    inline static AllocStats stats;
+
+    static void* allocate(std::size_t size) {
+        stats.frames++;
+        stats.upstream++;
+        stats.lastFrameSize = size;
+        return ::operator new(size);
+    }
+
+    static void deallocate(void* ptr, std::size_t) {
+        ::operator delete(ptr);
+    }
+};
+
+// 固定長ブロックのフリーリスト。上流への確保はチャンク単位でのみ発生する
+struct PooledFrameAllocator {
+    static constexpr std::size_t kBlockSize = 512;
+    static constexpr std::size_t kBlocksPerChunk = 256;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    inline static AllocStats stats;
+    inline static FreeBlock* freeList = nullptr;
+    inline static std::vector<void*> chunks;
+
+    static void* allocate(std::size_t size) {
+        stats.frames++;
+        stats.lastFrameSize = size;
+        if (size > kBlockSize) {
+            stats.upstream++;
+            return ::operator new(size);
+        }
+        if (freeList == nullptr) {
+            refill();
+        }
+        FreeBlock* block = freeList;
+        freeList = block->next;
+        return block;
+    }
+
+    static void deallocate(void* ptr, std::size_t size) {
+        if (size > kBlockSize) {
+            ::operator delete(ptr);
+            return;
+        }
+        auto* block = static_cast<FreeBlock*>(ptr);
+        block->next = freeList;
+        freeList = block;
+    }
+
+    static void refill() {
+        stats.upstream++;
+        char* chunk = static_cast<char*>(::operator new(kBlockSize * kBlocksPerChunk));
+        chunks.push_back(chunk);
+        for (std::size_t i = 0; i < kBlocksPerChunk; i++) {
+            auto* block = reinterpret_cast<FreeBlock*>(chunk + i * kBlockSize);
+            block->next = freeList;
+            freeList = block;
+        }
+    }
+
+    static void release() {
+        for (void* chunk : chunks) {
+            ::operator delete(chunk);
+        }
+        chunks.clear();
+        freeList = nullptr;
+    }
+};
+
+template <typename Allocator>
+class Task {
+public:
+    struct promise_type {
+        static void* operator new(std::size_t size) { return Allocator::allocate(size); }
+        static void operator delete(void* ptr, std::size_t size) { Allocator::deallocate(ptr, size); }
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    void resume() { handle_.resume(); }
+    std::coroutine_handle<> handle() const { return handle_; }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+template <typename T, typename Allocator>
+class Generator {
+public:
+    // next() による resume の回数（パイプライン各段の切り替え回数の計測用）
+    inline static long long resumes = 0;
+
+    struct promise_type {
+        T current{};
+
+        static void* operator new(std::size_t size) { return Allocator::allocate(size); }
+        static void operator delete(void* ptr, std::size_t size) { Allocator::deallocate(ptr, size); }
+
+        Generator get_return_object() { return Generator(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(T value) noexcept {
+            current = value;
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    explicit Generator(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    Generator(Generator&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+    ~Generator() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool next() {
+        resumes++;
+        handle_.resume();
+        return !handle_.done();
+    }
+    T value() const { return handle_.promise().current; }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// シングルスレッドのFIFOスケジューラ
+struct Scheduler {
+    std::deque<std::coroutine_handle<>> ready;
+    long long switches = 0;
+
+    void schedule(std::coroutine_handle<> handle) { ready.push_back(handle); }
+
+    void run() {
+        while (!ready.empty()) {
+            auto handle = ready.front();
+            ready.pop_front();
+            switches++;
+            handle.resume();
+        }
+    }
+};
+
+// 片方向の通知。待機中のコルーチンがあればスケジューラに戻す
+struct Baton {
+    Scheduler& scheduler;
+    std::coroutine_handle<> waiter;
+    bool signaled = false;
+
+    explicit Baton(Scheduler& scheduler) : scheduler(scheduler) {}
+
+    void post() {
+        if (waiter) {
+            scheduler.schedule(std::exchange(waiter, {}));
+        } else {
+            signaled = true;
+        }
+    }
+
+    auto wait() {
+        struct Awaiter {
+            Baton& baton;
+            bool await_ready() noexcept { return std::exchange(baton.signaled, false); }
+            void await_suspend(std::coroutine_handle<> handle) noexcept { baton.waiter = handle; }
+            void await_resume() noexcept {}
+        };
+        return Awaiter{*this};
+    }
+};
+
+using PooledTask = Task<PooledFrameAllocator>;
+using PooledGenerator = Generator<long long, PooledFrameAllocator>;
+
+template <typename Allocator>
+Task<Allocator> counterTask(long long& counter) {
+    counter++;
+    co_return;
+}
+
+PooledGenerator sourceStage(long long count) {
+    for (long long i = 0; i < count; i++) {
+        co_yield i;
+    }
+}
+
+PooledGenerator mapStage(PooledGenerator input) {
+    while (input.next()) {
+        co_yield input.value() * 3 + 1;
+    }
+}
+
+PooledGenerator filterStage(PooledGenerator input) {
+    while (input.next()) {
+        long long value = input.value();
+        if (value % 2 == 0) {
+            co_yield value;
+        }
+    }
+}
+
+void sourceCallback(long long count, const std::function<void(long long)>& sink) {
+    for (long long i = 0; i < count; i++) {
+        sink(i);
+    }
+}
+
+PooledTask pingTask(Baton& self, Baton& peer, int rounds) {
+    for (int i = 0; i < rounds; i++) {
+        peer.post();
+        co_await self.wait();
+    }
+}
+
+PooledTask pongTask(Baton& self, Baton& peer, int rounds) {
+    for (int i = 0; i < rounds; i++) {
+        co_await self.wait();
+        peer.post();
+    }
+}
+
+template <typename Allocator>
+BenchmarkResult runLifecycle(const std::string& name) {
+    const int iterations = 1000000;
+    long long counter = 0;
+    Allocator::stats = AllocStats();
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // 生成 → resume（完了まで実行）→ 破棄
+    for (int i = 0; i < iterations; i++) {
+        auto task = counterTask<Allocator>(counter);
+        task.resume();
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    double durationSeconds = duration / 1e9;
+
+    if (counter != iterations) {
+        std::cout << "Unexpected coroutine count" << std::endl;
+    }
+
+    const AllocStats& stats = Allocator::stats;
+    BenchmarkResult result(name, duration, 0, iterations, iterations / durationSeconds);
+    result.metrics = {
+        {"ns_per_frame", static_cast<double>(duration) / iterations},
+        {"allocs_per_frame", static_cast<double>(stats.frames) / iterations},
+        {"heap_allocs_per_frame", static_cast<double>(stats.upstream) / iterations},
+        {"frame_bytes", static_cast<double>(stats.lastFrameSize)},
+    };
+    return result;
+}
+
+}
+
+std::vector<BenchmarkResult> CoroutineBenchmark::runAllBenchmarks() {
+    std::vector<BenchmarkResult> results;
+
+    std::cout << "Running coroutine lifecycle benchmarks..." << std::endl;
+    results.push_back(benchmarkLifecyclePooled());
+    results.push_back(benchmarkLifecycleDefault());
+
+    std::cout << "Running pipeline benchmarks..." << std::endl;
+    results.push_back(benchmarkGeneratorPipeline());
+    results.push_back(benchmarkCallbackChain());
+
+    std::cout << "Running ping-pong benchmarks..." << std::endl;
+    results.push_back(benchmarkThreadPingPong());
+    results.push_back(benchmarkCoroutinePingPong());
+
+    PooledFrameAllocator::release();
+    return results;
+}
+
+BenchmarkResult CoroutineBenchmark::benchmarkLifecyclePooled() {
+    return runLifecycle<PooledFrameAllocator>("Coroutine Lifecycle (1M, pooled frames)");
+}
+
+BenchmarkResult CoroutineBenchmark::benchmarkLifecycleDefault() {
+    return runLifecycle<DefaultFrameAllocator>("Coroutine Lifecycle (1M, operator new)");
+}
+
+BenchmarkResult CoroutineBenchmark::benchmarkGeneratorPipeline() {
+    const long long elements = 1000000;
+    PooledFrameAllocator::stats = AllocStats();
+    PooledGenerator::resumes = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    long long sum = 0;
+    auto pipeline = filterStage(mapStage(sourceStage(elements)));
+    while (pipeline.next()) {
+        sum += pipeline.value();
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    double durationSeconds = duration / 1e9;
+
+    if (sum == 0) {
+        std::cout << "Unexpected zero sum" << std::endl;
+    }
+
+    // filter は偶数だけを yield するので、段ごとの resume 回数は実測する
+    const AllocStats& stats = PooledFrameAllocator::stats;
+    long long switches = PooledGenerator::resumes;
+    BenchmarkResult result("Generator Pipeline (1M elements)", duration, 0, elements, elements / durationSeconds);
+    result.metrics = {
+        {"ns_per_element", static_cast<double>(duration) / elements},
+        {"ns_per_switch", static_cast<double>(duration) / switches},
+        {"switches", static_cast<double>(switches)},
+        {"frames", static_cast<double>(stats.frames)},
+        {"heap_allocs_per_frame", static_cast<double>(stats.upstream) / stats.frames},
+    };
+    return result;
+}
+
+BenchmarkResult CoroutineBenchmark::benchmarkCallbackChain() {
+    const long long elements = 1000000;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    long long sum = 0;
+    std::function<void(long long)> filter = [&sum](long long value) {
+        if (value % 2 == 0) {
+            sum += value;
+        }
+    };
+    std::function<void(long long)> map = [&filter](long long value) {
+        filter(value * 3 + 1);
+    };
+    sourceCallback(elements, map);
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    double durationSeconds = duration / 1e9;
+
+    if (sum == 0) {
+        std::cout << "Unexpected zero sum" << std::endl;
+    }
+
+    BenchmarkResult result("Callback Chain (1M elements)", duration, 0, elements, elements / durationSeconds);
+    result.metrics = {
+        {"ns_per_element", static_cast<double>(duration) / elements},
+    };
+    return result;
+}
+
+BenchmarkResult CoroutineBenchmark::benchmarkThreadPingPong() {
+    const int rounds = 20000;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool pongTurn = false;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::thread pong([&]() {
+        for (int i = 0; i < rounds; i++) {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]() { return pongTurn; });
+            pongTurn = false;
+            cv.notify_one();
+        }
+    });
+
+    for (int i = 0; i < rounds; i++) {
+        std::unique_lock<std::mutex> lock(mutex);
+        pongTurn = true;
+        cv.notify_one();
+        cv.wait(lock, [&]() { return !pongTurn; });
+    }
+    pong.join();
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    double durationSeconds = duration / 1e9;
+
+    long long switches = static_cast<long long>(rounds) * 2;
+    BenchmarkResult result("Thread Ping-Pong (20k round trips)", duration, 0, switches, switches / durationSeconds);
+    result.metrics = {
+        {"ns_per_switch", static_cast<double>(duration) / switches},
+    };
+    return result;
+}
+
+BenchmarkResult CoroutineBenchmark::benchmarkCoroutinePingPong() {
+    const int rounds = 1000000;
+    PooledFrameAllocator::stats = AllocStats();
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    Scheduler scheduler;
+    Baton ping(scheduler);
+    Baton pong(scheduler);
+    auto pingCoroutine = pingTask(ping, pong, rounds);
+    auto pongCoroutine = pongTask(pong, ping, rounds);
+    scheduler.schedule(pingCoroutine.handle());
+    scheduler.schedule(pongCoroutine.handle());
+    scheduler.run();
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    double durationSeconds = duration / 1e9;
+
+    long long switches = scheduler.switches;
+    const AllocStats& stats = PooledFrameAllocator::stats;
+    BenchmarkResult result("Coroutine Ping-Pong (1M round trips)", duration, 0, switches, switches / durationSeconds);
+    result.metrics = {
+        {"ns_per_switch", static_cast<double>(duration) / switches},
+        {"frames", static_cast<double>(stats.frames)},
+        {"heap_allocs_per_frame", static_cast<double>(stats.upstream) / stats.frames},
+    };
+    return result;
+}
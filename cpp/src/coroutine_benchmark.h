@@ -0,0 +1,18 @@
+#pragma once
+
+#include "benchmark.h"
+#include <vector>
+
+// C++20 コルーチンとスレッドの切り替えコスト比較（BENCHMARK_ENABLE_COROUTINES でのみビルド）
+class CoroutineBenchmark {
+public:
+    static std::vector<BenchmarkResult> runAllBenchmarks();
+
+private:
+    static BenchmarkResult benchmarkLifecyclePooled();
+    static BenchmarkResult benchmarkLifecycleDefault();
+    static BenchmarkResult benchmarkGeneratorPipeline();
+    static BenchmarkResult benchmarkCallbackChain();
+    static BenchmarkResult benchmarkThreadPingPong();
+    static BenchmarkResult benchmarkCoroutinePingPong();
+};
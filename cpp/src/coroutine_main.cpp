@@ -0,0 +1,28 @@
+#include "coroutine_benchmark.h"
+#include "output.h"
+#include <iostream>
+#include <chrono>
+#include <iomanip>
+
+int main() {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    
+    auto results = CoroutineBenchmark::runAllBenchmarks();
+    
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto totalDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime);
+    double totalTime = totalDuration.count() / 1e9;
+    
+    Output::printResults(results);
+    
+    try {
+        Output::saveResultsToJSON(results, totalTime, "coroutine");
+    } catch (const std::exception& e) {
+        std::cerr << "Error saving results: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    std::cout << "Total execution time: " << std::fixed << std::setprecision(3) << totalTime << " seconds" << std::endl;
+    
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,459 @@
+#include "daemon.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+const double kQuantiles[] = {0.5, 0.9, 0.99};
+const int kPollMs = 200;
+const int kClockCalibrationCalls = 1000;
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void requestStop(int) {
+    stopRequested = 1;
+}
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+double processCpuSeconds() {
+    timespec now{};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+double unixTimeSeconds() {
+    return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// 停止要求を見ながら眠る（シグナルで condition_variable は起こせないため小刻みに）
+void sleepFor(double seconds) {
+    auto deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    while (!stopRequested && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::min<Clock::duration>(deadline - Clock::now(), std::chrono::milliseconds(kPollMs)));
+    }
+}
+
+// 容量固定。満杯になったら最も古い要素を上書きする
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity) : items_(std::max<size_t>(capacity, 1)) {}
+
+    void push(const T& item) {
+        items_[next_] = item;
+        next_ = (next_ + 1) % items_.size();
+        size_ = std::min(size_ + 1, items_.size());
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return items_.size(); }
+
+    // 古い順
+    template <typename F>
+    void forEach(F&& visit) const {
+        size_t first = (next_ + items_.size() - size_) % items_.size();
+        for (size_t i = 0; i < size_; i++) {
+            visit(items_[(first + i) % items_.size()]);
+        }
+    }
+
+private:
+    std::vector<T> items_;
+    size_t next_ = 0;
+    size_t size_ = 0;
+};
+
+struct Sample {
+    double durationSeconds;
+    double opsPerSec;
+    double untimedRatio;  // 実行全体の壁時計のうち、計測区間の外（入力生成・検証など）だった割合
+};
+
+struct BenchmarkStats {
+    explicit BenchmarkStats(size_t window) : samples(window) {}
+
+    RingBuffer<Sample> samples;
+    long long runs = 0;
+    long long failures = 0;
+    double durationSum = 0.0;
+    double cpuSeconds = 0.0;
+    double lastRunTimestamp = 0.0;
+};
+
+struct DaemonState {
+    std::mutex mutex;
+    std::vector<std::pair<std::string, BenchmarkStats>> benchmarks;
+    DaemonOptions options;
+    Clock::time_point started = Clock::now();
+    long long cycles = 0;
+    long long scrapes = 0;
+    double lastCycleSeconds = 0.0;
+    double throttleSeconds = 0.0;
+    double clockOverheadSeconds = 0.0;
+    double bookkeepingSeconds = 0.0;  // 記録とスクレイプ応答にかかった時間
+};
+
+double clockOverhead() {
+    auto start = Clock::now();
+    Clock::time_point last = start;
+    for (int i = 0; i < kClockCalibrationCalls; i++) {
+        last = Clock::now();
+    }
+    return std::chrono::duration<double>(last - start).count() / kClockCalibrationCalls;
+}
+
+double quantile(std::vector<double>& sorted, double q) {
+    size_t rank = static_cast<size_t>(std::ceil(q * sorted.size()));
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+struct WindowStats {
+    double durationStddev = 0.0;
+    double meanOpsPerSec = 0.0;
+    double meanUntimedRatio = 0.0;
+};
+
+WindowStats windowStats(const RingBuffer<Sample>& samples) {
+    WindowStats stats;
+    double count = static_cast<double>(samples.size());
+    double meanDuration = 0.0;
+    samples.forEach([&](const Sample& sample) {
+        meanDuration += sample.durationSeconds / count;
+        stats.meanOpsPerSec += sample.opsPerSec / count;
+        stats.meanUntimedRatio += sample.untimedRatio / count;
+    });
+    double variance = 0.0;
+    samples.forEach([&](const Sample& sample) {
+        variance += (sample.durationSeconds - meanDuration) * (sample.durationSeconds - meanDuration) / count;
+    });
+    stats.durationStddev = std::sqrt(variance);
+    return stats;
+}
+
+std::string escapeLabel(const std::string& value) {
+    std::string escaped;
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+        }
+        escaped += c == '\n' ? 'n' : c;
+    }
+    return escaped;
+}
+
+void writeHeader(std::ostream& out, const char* name, const char* type, const char* help) {
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " " << type << "\n";
+}
+
+std::string renderMetrics(DaemonState& state) {
+    auto start = Clock::now();
+    std::ostringstream out;
+    out << std::setprecision(15);
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.scrapes++;
+
+    writeHeader(out, "benchmark_duration_seconds", "summary",
+                "Benchmark duration; quantiles over the ring buffer window, sum and count since start.");
+    for (const auto& entry : state.benchmarks) {
+        std::string label = "benchmark=\"" + escapeLabel(entry.first) + "\"";
+        std::vector<double> durations;
+        entry.second.samples.forEach([&durations](const Sample& sample) { durations.push_back(sample.durationSeconds); });
+        std::sort(durations.begin(), durations.end());
+        if (!durations.empty()) {
+            for (double q : kQuantiles) {
+                out << "benchmark_duration_seconds{" << label << ",quantile=\"" << q << "\"} "
+                    << quantile(durations, q) << "\n";
+            }
+        }
+        out << "benchmark_duration_seconds_sum{" << label << "} " << entry.second.durationSum << "\n";
+        out << "benchmark_duration_seconds_count{" << label << "} " << entry.second.runs << "\n";
+    }
+
+    // 窓内の平均などはファミリーごとにまとめて出す必要があるので先に計算する
+    std::vector<std::pair<std::string, WindowStats>> windows;
+    for (const auto& entry : state.benchmarks) {
+        if (entry.second.samples.size() > 0) {
+            windows.emplace_back("{benchmark=\"" + escapeLabel(entry.first) + "\"} ", windowStats(entry.second.samples));
+        }
+    }
+    writeHeader(out, "benchmark_duration_stddev_seconds", "gauge",
+                "Standard deviation of benchmark duration over the ring buffer window.");
+    for (const auto& window : windows) {
+        out << "benchmark_duration_stddev_seconds" << window.first << window.second.durationStddev << "\n";
+    }
+    writeHeader(out, "benchmark_ops_per_second", "gauge", "Mean ops/sec over the ring buffer window.");
+    for (const auto& window : windows) {
+        out << "benchmark_ops_per_second" << window.first << window.second.meanOpsPerSec << "\n";
+    }
+    // ハーネス自身のコストではなく、入力生成や検証を含む計測区間外の時間（ハーネスのコストは daemon_* で出す）
+    writeHeader(out, "benchmark_untimed_ratio", "gauge",
+                "Mean share of each run's wall time outside the timed region (setup, input generation, validation).");
+    for (const auto& window : windows) {
+        out << "benchmark_untimed_ratio" << window.first << window.second.meanUntimedRatio << "\n";
+    }
+
+    writeHeader(out, "benchmark_failures_total", "counter", "Runs that threw an exception.");
+    for (const auto& entry : state.benchmarks) {
+        out << "benchmark_failures_total{benchmark=\"" << escapeLabel(entry.first) << "\"} "
+            << entry.second.failures << "\n";
+    }
+    writeHeader(out, "benchmark_cpu_seconds_total", "counter", "Process CPU time spent running each benchmark.");
+    for (const auto& entry : state.benchmarks) {
+        out << "benchmark_cpu_seconds_total{benchmark=\"" << escapeLabel(entry.first) << "\"} "
+            << entry.second.cpuSeconds << "\n";
+    }
+    writeHeader(out, "benchmark_last_run_timestamp_seconds", "gauge", "Unix time of the last completed run.");
+    for (const auto& entry : state.benchmarks) {
+        out << "benchmark_last_run_timestamp_seconds{benchmark=\"" << escapeLabel(entry.first) << "\"} "
+            << entry.second.lastRunTimestamp << "\n";
+    }
+
+    double uptime = secondsSince(state.started);
+    double cpuSeconds = processCpuSeconds();
+    size_t window = state.benchmarks.empty() ? 0 : state.benchmarks.front().second.samples.capacity();
+    writeHeader(out, "benchmark_daemon_window_size", "gauge", "Ring buffer capacity per benchmark.");
+    out << "benchmark_daemon_window_size " << window << "\n";
+    writeHeader(out, "benchmark_daemon_cycles_total", "counter", "Completed passes over the benchmark list.");
+    out << "benchmark_daemon_cycles_total " << state.cycles << "\n";
+    writeHeader(out, "benchmark_daemon_last_cycle_seconds", "gauge", "Wall time of the last pass including throttling.");
+    out << "benchmark_daemon_last_cycle_seconds " << state.lastCycleSeconds << "\n";
+    writeHeader(out, "benchmark_daemon_cpu_budget_ratio", "gauge", "Configured CPU budget.");
+    out << "benchmark_daemon_cpu_budget_ratio " << state.options.cpuBudget << "\n";
+    writeHeader(out, "benchmark_daemon_cpu_usage_ratio", "gauge", "Process CPU time divided by uptime.");
+    out << "benchmark_daemon_cpu_usage_ratio " << (uptime > 0 ? cpuSeconds / uptime : 0.0) << "\n";
+    writeHeader(out, "benchmark_daemon_throttle_seconds_total", "counter", "Time slept to stay within the CPU budget.");
+    out << "benchmark_daemon_throttle_seconds_total " << state.throttleSeconds << "\n";
+    writeHeader(out, "benchmark_daemon_clock_overhead_seconds", "gauge", "Cost of one clock read, calibrated each pass.");
+    out << "benchmark_daemon_clock_overhead_seconds " << state.clockOverheadSeconds << "\n";
+    writeHeader(out, "benchmark_daemon_bookkeeping_seconds_total", "counter",
+                "Time spent recording samples and rendering scrapes.");
+    out << "benchmark_daemon_bookkeeping_seconds_total " << state.bookkeepingSeconds << "\n";
+    writeHeader(out, "benchmark_daemon_scrapes_total", "counter", "Metrics requests served.");
+    out << "benchmark_daemon_scrapes_total " << state.scrapes << "\n";
+    writeHeader(out, "benchmark_daemon_uptime_seconds", "gauge", "Seconds since the daemon started.");
+    out << "benchmark_daemon_uptime_seconds " << uptime << "\n";
+
+    state.bookkeepingSeconds += secondsSince(start);
+    return out.str();
+}
+
+int openListener(const std::string& address, std::string& unixPath) {
+    if (address.compare(0, 5, "unix:") == 0) {
+        unixPath = address.substr(5);
+        sockaddr_un local{};
+        if (unixPath.empty() || unixPath.size() >= sizeof(local.sun_path)) {
+            throw std::runtime_error("Invalid unix socket path: " + unixPath);
+        }
+        local.sun_family = AF_UNIX;
+        unixPath.copy(local.sun_path, sizeof(local.sun_path) - 1);
+        int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        unlink(unixPath.c_str());
+        if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0 ||
+            listen(listener, 16) != 0) {
+            throw std::runtime_error("Could not listen on " + address + ": " + std::strerror(errno));
+        }
+        return listener;
+    }
+
+    size_t colon = address.rfind(':');
+    std::string host = colon == std::string::npos ? "127.0.0.1" : address.substr(0, colon);
+    std::string port = colon == std::string::npos ? address : address.substr(colon + 1);
+    sockaddr_in inet{};
+    inet.sin_family = AF_INET;
+    if (host.empty() || host == "localhost") {
+        host = "127.0.0.1";
+    }
+    if (port.empty() || port.find_first_not_of("0123456789") != std::string::npos || std::stoi(port) > 65535 ||
+        inet_pton(AF_INET, host.c_str(), &inet.sin_addr) != 1) {
+        throw std::runtime_error("Invalid listen address: " + address);
+    }
+    inet.sin_port = htons(static_cast<uint16_t>(std::stoi(port)));
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    if (listener >= 0) {
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    }
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&inet), sizeof(inet)) != 0 ||
+        listen(listener, 16) != 0) {
+        throw std::runtime_error("Could not listen on " + address + ": " + std::strerror(errno));
+    }
+    return listener;
+}
+
+void sendAll(int connection, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t written = send(connection, data.data() + sent, data.size() - sent, 0);
+        if (written <= 0) {
+            return;
+        }
+        sent += static_cast<size_t>(written);
+    }
+}
+
+void handleConnection(int connection, DaemonState& state) {
+    timeval timeout{1, 0};
+    setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        ssize_t received = recv(connection, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            break;
+        }
+        request.append(buffer, static_cast<size_t>(received));
+    }
+
+    // リクエスト行 "GET <path> HTTP/1.1" のパスだけを見る
+    std::string path;
+    if (request.compare(0, 4, "GET ") == 0) {
+        path = request.substr(4, request.find(' ', 4) - 4);
+        path = path.substr(0, path.find('?'));
+    }
+    std::string status = "404 Not Found";
+    std::string body = "Not found; metrics are at /metrics\n";
+    if (path == "/metrics") {
+        status = "200 OK";
+        body = renderMetrics(state);
+    }
+    std::ostringstream response;
+    response << "HTTP/1.1 " << status << "\r\n"
+             << "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+    sendAll(connection, response.str());
+}
+
+void serveMetrics(int listener, DaemonState& state) {
+    while (!stopRequested) {
+        pollfd ready{listener, POLLIN, 0};
+        if (poll(&ready, 1, kPollMs) <= 0) {
+            continue;
+        }
+        int connection = accept(listener, nullptr, nullptr);
+        if (connection < 0) {
+            continue;
+        }
+        handleConnection(connection, state);
+        close(connection);
+    }
+}
+
+void recordRun(DaemonState& state, size_t index, const BenchmarkResult* result,
+               double wallSeconds, double cpuSeconds) {
+    auto start = Clock::now();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    BenchmarkStats& stats = state.benchmarks[index].second;
+    stats.cpuSeconds += cpuSeconds;
+    stats.lastRunTimestamp = unixTimeSeconds();
+    if (result == nullptr) {
+        stats.failures++;
+    } else {
+        double duration = result->duration_ns / 1e9;
+        double untimed = wallSeconds > 0 ? std::max(0.0, wallSeconds - duration) / wallSeconds : 0.0;
+        stats.samples.push({duration, result->ops_per_sec, untimed});
+        stats.runs++;
+        stats.durationSum += duration;
+    }
+    state.bookkeepingSeconds += secondsSince(start);
+}
+
+}
+
+int Daemon::run(const std::vector<BenchmarkCase>& cases, const DaemonOptions& options) {
+    DaemonState state;
+    state.options = options;
+    size_t window = Benchmark::sizesFromEnv("BENCHMARK_DAEMON_WINDOW", {120})[0];
+    for (const auto& benchmarkCase : cases) {
+        state.benchmarks.emplace_back(benchmarkCase.id, BenchmarkStats(window));
+    }
+
+    std::string unixPath;
+    int listener = openListener(options.listen, unixPath);
+
+    struct sigaction action {};
+    action.sa_handler = requestStop;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    // スクレイプ側が先に切断しても落ちないようにする
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::cout << "Serving metrics on " << options.listen << "/metrics (" << cases.size() << " benchmarks every "
+              << options.intervalSeconds << "s, CPU budget " << options.cpuBudget * 100 << "%)" << std::endl;
+    std::thread server(serveMetrics, listener, std::ref(state));
+
+    while (!stopRequested) {
+        auto cycleStart = Clock::now();
+        double clockCost = clockOverhead();
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.clockOverheadSeconds = clockCost;
+        }
+
+        for (size_t i = 0; i < cases.size() && !stopRequested; i++) {
+            double cpuBefore = processCpuSeconds();
+            auto runStart = Clock::now();
+            try {
+                BenchmarkResult result = cases[i].run();
+                recordRun(state, i, &result, secondsSince(runStart), processCpuSeconds() - cpuBefore);
+            } catch (const std::exception& e) {
+                std::cerr << "Benchmark " << cases[i].id << " failed: " << e.what() << std::endl;
+                recordRun(state, i, nullptr, secondsSince(runStart), processCpuSeconds() - cpuBefore);
+            }
+
+            // 使った CPU 時間 / (実行 + 休止) が予算に収まるまで休む
+            double cpuUsed = processCpuSeconds() - cpuBefore;
+            double throttle = cpuUsed / options.cpuBudget - secondsSince(runStart);
+            if (throttle > 0) {
+                sleepFor(throttle);
+                std::lock_guard<std::mutex> lock(state.mutex);
+                state.throttleSeconds += throttle;
+            }
+        }
+
+        double elapsed = secondsSince(cycleStart);
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.cycles++;
+            state.lastCycleSeconds = elapsed;
+        }
+        sleepFor(options.intervalSeconds - elapsed);
+    }
+
+    std::cout << "Stopping after " << state.cycles << " cycles" << std::endl;
+    server.join();
+    close(listener);
+    if (!unixPath.empty()) {
+        unlink(unixPath.c_str());
+    }
+    return 0;
+}
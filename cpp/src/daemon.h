@@ -0,0 +1,19 @@
+#pragma once
+
+#include "benchmark.h"
+#include <string>
+#include <vector>
+
+struct DaemonOptions {
+    double intervalSeconds = 60.0;          // 1巡を始める周期
+    double cpuBudget = 0.05;                // ベンチマークに使ってよい CPU 時間の割合（1コア換算）
+    std::string listen = "127.0.0.1:9464";  // "host:port"、"port" または "unix:/path"
+};
+
+// 選んだベンチマークを周期的に繰り返し、直近 BENCHMARK_DAEMON_WINDOW 回（既定 120）の
+// 統計をリングバッファに持って Prometheus テキスト形式で /metrics に出す。
+// CPU 予算を超えないよう、各実行のあとに使った CPU 時間に比例して休む。SIGINT / SIGTERM で終了
+class Daemon {
+public:
+    static int run(const std::vector<BenchmarkCase>& cases, const DaemonOptions& options);
+};
@@ -0,0 +1,431 @@
+#include "external_sort.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace {
+
+using Key = uint64_t;
+
+const size_t kMB = 1024 * 1024;
+const size_t kMinMergeBufferBytes = 64 * 1024;
+const size_t kGenerateBufferKeys = 512 * 1024;
+
+long long nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// read/write/mmap/fdatasync に掛かった時間（残りをCPU時間とみなす）
+struct IoClock {
+    long long ioNs = 0;
+
+    template <typename Fn>
+    void measure(Fn&& fn) {
+        long long start = nowNs();
+        fn();
+        ioNs += nowNs() - start;
+    }
+};
+
+// 作成直後に unlink するので、途中で落ちてもファイルは残らない
+class TempFile {
+public:
+    TempFile() {
+        static std::atomic<int> counter{0};
+        const char* dir = std::getenv("BENCHMARK_EXTSORT_DIR");
+        std::string path = std::string(dir != nullptr ? dir : ".") + "/extsort_" +
+            std::to_string(getpid()) + "_" + std::to_string(counter++) + ".bin";
+        fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (fd_ < 0) {
+            throw std::runtime_error("Could not create " + path);
+        }
+        unlink(path.c_str());
+    }
+    TempFile(const TempFile&) = delete;
+    TempFile& operator=(const TempFile&) = delete;
+    ~TempFile() { close(fd_); }
+
+    int fd() const { return fd_; }
+
+private:
+    int fd_;
+};
+
+void readFully(int fd, void* data, size_t bytes, off_t offset) {
+    char* out = static_cast<char*>(data);
+    while (bytes > 0) {
+        ssize_t n = pread(fd, out, bytes, offset);
+        if (n <= 0) {
+            throw std::runtime_error("Short read from sort file");
+        }
+        out += n;
+        bytes -= static_cast<size_t>(n);
+        offset += n;
+    }
+}
+
+void writeFully(int fd, const void* data, size_t bytes, off_t offset) {
+    const char* in = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t n = pwrite(fd, in, bytes, offset);
+        if (n <= 0) {
+            throw std::runtime_error("Short write to sort file");
+        }
+        in += n;
+        bytes -= static_cast<size_t>(n);
+        offset += n;
+    }
+}
+
+// 書き戻しまで I/O 時間に含め、次の段階の読み込みがページキャッシュに当たらないようにする
+void syncAndDrop(int fd) {
+    fdatasync(fd);
+#ifdef POSIX_FADV_DONTNEED
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+}
+
+void resetPeakRss() {
+#ifdef __linux__
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+#endif
+}
+
+long long peakRssBytes() {
+#ifdef __linux__
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::stoll(line.substr(6)) * 1024;
+        }
+    }
+#endif
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss;
+#else
+    return usage.ru_maxrss * 1024LL;
+#endif
+}
+
+struct Run {
+    off_t offset;
+    size_t keys;
+};
+
+Key generateInput(int fd, size_t keys) {
+    // splitmix64（再現可能性のため固定シード）
+    uint64_t state = 42;
+    Key checksum = 0;
+    std::vector<Key> buffer(kGenerateBufferKeys);
+    for (size_t written = 0; written < keys;) {
+        size_t count = std::min(buffer.size(), keys - written);
+        for (size_t i = 0; i < count; i++) {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            buffer[i] = z ^ (z >> 31);
+            checksum += buffer[i];
+        }
+        writeFully(fd, buffer.data(), count * sizeof(Key), static_cast<off_t>(written * sizeof(Key)));
+        written += count;
+    }
+    syncAndDrop(fd);
+    return checksum;
+}
+
+// 予算分ずつ読み込んでソートし、ランとして連続に書き出す
+std::vector<Run> formRuns(int inputFd, size_t totalKeys, int runFd, size_t budgetKeys,
+                          bool useMmap, IoClock& io) {
+    std::vector<Run> runs;
+    std::vector<Key> buffer(useMmap ? 0 : budgetKeys);
+    long pageSize = sysconf(_SC_PAGESIZE);
+
+    for (size_t start = 0; start < totalKeys; start += budgetKeys) {
+        size_t count = std::min(budgetKeys, totalKeys - start);
+        size_t bytes = count * sizeof(Key);
+        off_t offset = static_cast<off_t>(start * sizeof(Key));
+        Key* keys = buffer.data();
+        void* mapping = MAP_FAILED;
+
+        if (useMmap) {
+            // MAP_PRIVATE なのでその場でソートしても入力ファイルは書き換わらない
+            io.measure([&]() {
+                mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, inputFd, offset);
+                if (mapping == MAP_FAILED) {
+                    throw std::runtime_error("Could not mmap sort input");
+                }
+                // ページインを I/O 側に計上する
+                volatile const char* bytesIn = static_cast<const char*>(mapping);
+                for (size_t page = 0; page < bytes; page += static_cast<size_t>(pageSize)) {
+                    (void)bytesIn[page];
+                }
+            });
+            keys = static_cast<Key*>(mapping);
+        } else {
+            io.measure([&]() { readFully(inputFd, keys, bytes, offset); });
+        }
+
+        std::sort(keys, keys + count);
+        io.measure([&]() { writeFully(runFd, keys, bytes, offset); });
+        runs.push_back({offset, count});
+
+        if (useMmap) {
+            munmap(mapping, bytes);
+        }
+    }
+
+    io.measure([&]() { syncAndDrop(runFd); });
+    return runs;
+}
+
+class RunReader {
+public:
+    RunReader(int fd, const Run& run, size_t bufferKeys)
+        : fd_(fd), next_(run.offset), remaining_(run.keys), buffer_(bufferKeys) {}
+
+    bool refill(IoClock& io) {
+        size_t count = std::min(buffer_.size(), remaining_);
+        if (count == 0) {
+            return false;
+        }
+        io.measure([&]() { readFully(fd_, buffer_.data(), count * sizeof(Key), next_); });
+        next_ += static_cast<off_t>(count * sizeof(Key));
+        remaining_ -= count;
+        position_ = 0;
+        available_ = count;
+        return true;
+    }
+
+    // 次のキーへ進める。ランを読み切ったら false
+    bool advance(IoClock& io) {
+        return ++position_ < available_ || refill(io);
+    }
+
+    Key current() const { return buffer_[position_]; }
+
+private:
+    int fd_;
+    off_t next_;
+    size_t remaining_;
+    std::vector<Key> buffer_;
+    size_t position_ = 0;
+    size_t available_ = 0;
+};
+
+// tree_[0] が勝者、tree_[1..k-1] が各ノードの敗者。葉 k は構築用の番兵（-∞）
+class LoserTree {
+public:
+    explicit LoserTree(std::vector<RunReader>& readers, IoClock& io)
+        : readers_(readers), k_(static_cast<int>(readers.size())), tree_(k_, k_), done_(k_ + 1, false) {
+        for (int i = 0; i < k_; i++) {
+            done_[i] = !readers_[i].refill(io);
+        }
+        for (int i = k_ - 1; i >= 0; i--) {
+            adjust(i);
+        }
+    }
+
+    bool empty() const { return done_[tree_[0]]; }
+    Key top() const { return readers_[tree_[0]].current(); }
+
+    void pop(IoClock& io) {
+        int winner = tree_[0];
+        done_[winner] = !readers_[winner].advance(io);
+        adjust(winner);
+    }
+
+private:
+    bool beats(int a, int b) const {
+        if (a == k_ || b == k_) {
+            return a == k_;
+        }
+        if (done_[a] || done_[b]) {
+            return !done_[a];
+        }
+        return readers_[a].current() < readers_[b].current();
+    }
+
+    void adjust(int leaf) {
+        int winner = leaf;
+        for (int node = (leaf + k_) / 2; node > 0; node /= 2) {
+            if (beats(tree_[node], winner)) {
+                std::swap(tree_[node], winner);
+            }
+        }
+        tree_[0] = winner;
+    }
+
+    std::vector<RunReader>& readers_;
+    int k_;
+    std::vector<int> tree_;
+    std::vector<char> done_;
+};
+
+// runs をまとめて outFd の outOffset 以降に書き出し、できたランを返す
+Run mergeRuns(int inFd, const std::vector<Run>& runs, size_t first, size_t last,
+              int outFd, off_t outOffset, size_t inputBufferKeys,
+              std::vector<Key>& output, IoClock& io) {
+    std::vector<RunReader> readers;
+    readers.reserve(last - first);
+    for (size_t i = first; i < last; i++) {
+        readers.emplace_back(inFd, runs[i], inputBufferKeys);
+    }
+
+    LoserTree tree(readers, io);
+    Run merged{outOffset, 0};
+    size_t filled = 0;
+    off_t writeOffset = outOffset;
+    auto flush = [&]() {
+        io.measure([&]() { writeFully(outFd, output.data(), filled * sizeof(Key), writeOffset); });
+        writeOffset += static_cast<off_t>(filled * sizeof(Key));
+        merged.keys += filled;
+        filled = 0;
+    };
+
+    while (!tree.empty()) {
+        output[filled++] = tree.top();
+        if (filled == output.size()) {
+            flush();
+        }
+        tree.pop(io);
+    }
+    flush();
+    return merged;
+}
+
+bool verifySorted(int fd, size_t totalKeys, Key expectedChecksum) {
+    std::vector<Key> buffer(kGenerateBufferKeys);
+    Key previous = 0;
+    Key checksum = 0;
+    for (size_t start = 0; start < totalKeys; start += buffer.size()) {
+        size_t count = std::min(buffer.size(), totalKeys - start);
+        readFully(fd, buffer.data(), count * sizeof(Key), static_cast<off_t>(start * sizeof(Key)));
+        for (size_t i = 0; i < count; i++) {
+            if (buffer[i] < previous) {
+                return false;
+            }
+            previous = buffer[i];
+            checksum += buffer[i];
+        }
+    }
+    return checksum == expectedChecksum;
+}
+
+}
+
+const std::vector<BenchmarkCase>& ExternalSortBenchmark::registeredBenchmarks() {
+    static const std::vector<BenchmarkCase> cases = []() {
+        std::vector<BenchmarkCase> list;
+        // 0 MB はラン数 0（データ）や無限ループ（予算）になるので受け付けない
+        auto positiveSizes = [](const char* name, const std::vector<size_t>& fallback) {
+            std::vector<size_t> sizes;
+            for (size_t size : Benchmark::sizesFromEnv(name, fallback)) {
+                if (size == 0) {
+                    std::cerr << "Ignoring " << name << " entry 0; sizes must be positive" << std::endl;
+                } else {
+                    sizes.push_back(size);
+                }
+            }
+            return sizes;
+        };
+        for (size_t dataMB : positiveSizes("BENCHMARK_EXTSORT_DATA_MB", {256})) {
+            for (size_t budgetMB : positiveSizes("BENCHMARK_EXTSORT_BUDGET_MB", {16, 64})) {
+                for (bool useMmap : {false, true}) {
+                    std::string id = "extsort-" + std::to_string(dataMB) + "m-" +
+                        std::to_string(budgetMB) + "m-" + (useMmap ? "mmap" : "read");
+                    list.push_back({id, "external sort", [dataMB, budgetMB, useMmap]() {
+                        return benchmarkExternalSort(dataMB * kMB, budgetMB * kMB, useMmap);
+                    }});
+                }
+            }
+        }
+        return list;
+    }();
+    return cases;
+}
+
+BenchmarkResult ExternalSortBenchmark::benchmarkExternalSort(size_t dataBytes, size_t budgetBytes, bool useMmap) {
+    const size_t totalKeys = dataBytes / sizeof(Key);
+    const size_t budgetKeys = budgetBytes / sizeof(Key);
+    std::string name = "External Sort (" + std::to_string(dataBytes / kMB) + "MB, " +
+        std::to_string(budgetBytes / kMB) + "MB budget, " + (useMmap ? "mmap" : "read") + ")";
+    if (totalKeys == 0 || budgetKeys == 0) {
+        return BenchmarkResult(name, 0, 0, 0, 0.0);
+    }
+
+    TempFile input;
+    TempFile scratchA;
+    TempFile scratchB;
+    Key checksum = generateInput(input.fd(), totalKeys);
+
+    resetPeakRss();
+    IoClock io;
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // 1. ラン生成（予算いっぱいをソートバッファに使う）
+    std::vector<Run> runs = formRuns(input.fd(), totalKeys, scratchA.fd(), budgetKeys, useMmap, io);
+    size_t runCount = runs.size();
+
+    // 2. マージ。予算の 1/4 を出力バッファ、残りを各ランの入力バッファに割り当てる。
+    //    入力バッファが小さくなりすぎる場合は複数パスに分ける。
+    //    ランが1本だけなら scratchA の内容がそのまま結果なのでマージしない
+    std::vector<Key> output(std::max<size_t>(budgetKeys / 4, 1));
+    size_t fanIn = std::max<size_t>(2, (budgetBytes - budgetBytes / 4) / kMinMergeBufferBytes);
+    int source = scratchA.fd();
+    int target = scratchB.fd();
+    int passes = 0;
+    while (runs.size() > 1) {
+        size_t groupSize = std::min(fanIn, runs.size());
+        size_t inputBufferKeys = (budgetKeys - output.size()) / groupSize;
+        std::vector<Run> merged;
+        for (size_t first = 0; first < runs.size(); first += groupSize) {
+            size_t last = std::min(first + groupSize, runs.size());
+            off_t offset = runs[first].offset;
+            merged.push_back(mergeRuns(source, runs, first, last, target, offset,
+                                       inputBufferKeys, output, io));
+        }
+        io.measure([&]() { syncAndDrop(target); });
+        runs = merged;
+        std::swap(source, target);
+        passes++;
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    double durationSeconds = duration / 1e9;
+    long long peakRss = peakRssBytes();
+
+    if (!verifySorted(source, totalKeys, checksum)) {
+        std::cout << "External sort produced unsorted output" << std::endl;
+    }
+
+    double ioSeconds = io.ioNs / 1e9;
+    BenchmarkResult result(name, duration, peakRss, static_cast<long long>(totalKeys), totalKeys / durationSeconds);
+    result.metrics = {
+        {"gb_per_sec", dataBytes / 1e9 / durationSeconds},
+        {"io_seconds", ioSeconds},
+        {"cpu_seconds", durationSeconds - ioSeconds},
+        {"io_fraction", ioSeconds / durationSeconds},
+        {"peak_rss_mb", static_cast<double>(peakRss) / kMB},
+        {"runs", static_cast<double>(runCount)},
+        {"merge_passes", static_cast<double>(passes)},
+    };
+    return result;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "benchmark.h"
+#include <cstddef>
+#include <vector>
+
+// メモリ予算内でランを作り、loser tree で k-way マージする外部ソート。
+// データ量・予算は環境変数で変更できる（既定はサンドボックスでも回る大きさ）:
+//   BENCHMARK_EXTSORT_DATA_MB    例: "256,4096"
+//   BENCHMARK_EXTSORT_BUDGET_MB  例: "16,64"
+//   BENCHMARK_EXTSORT_DIR        一時ファイルの置き場所（既定はカレントディレクトリ）
+class ExternalSortBenchmark {
+public:
+    static const std::vector<BenchmarkCase>& registeredBenchmarks();
+
+private:
+    static BenchmarkResult benchmarkExternalSort(size_t dataBytes, size_t budgetBytes, bool useMmap);
+};
\ No newline at end of file
@@ -0,0 +1,550 @@
+#include "graph.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <thread>
+
+namespace {
+
+const int kMinScale = 16;
+const int kMaxScale = 26;
+const size_t kMaxThreadsPerHardwareThread = 4;
+const int kEdgeFactor = 16;
+const int kBfsRoots = 8;
+const int kPageRankIterations = 20;
+const double kDamping = 0.85;
+// 方向最適化 BFS の切り替え閾値（Beamer et al. の既定値）
+const uint64_t kAlpha = 15;
+const uint64_t kBeta = 18;
+
+struct Graph {
+    uint32_t vertices = 0;
+    std::vector<uint64_t> offsets;
+    std::vector<uint32_t> neighbors;
+
+    uint64_t degree(uint32_t v) const { return offsets[v + 1] - offsets[v]; }
+    long long bytes() const {
+        return static_cast<long long>(offsets.size() * sizeof(uint64_t) + neighbors.size() * sizeof(uint32_t));
+    }
+};
+
+using Parents = std::vector<std::atomic<int32_t>>;
+using Bitmap = std::vector<uint64_t>;
+
+struct SplitMix64 {
+    uint64_t state;
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    double uniform() { return (next() >> 11) * 0x1.0p-53; }
+};
+
+// 1回の探索 / PageRank の間だけワーカーを起動しておき、各ステップは世代カウンタのバリアで同期する。
+// 呼び出し元のスレッドも thread 0 として働く
+class WorkerPool {
+public:
+    explicit WorkerPool(int threads) : threads_(std::max(1, threads)) {
+        for (int t = 1; t < threads_; t++) {
+            workers_.emplace_back([this, t]() { work(t); });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+            generation_++;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    int threads() const { return threads_; }
+
+    // [0, count) を threads 個に分けて fn(begin, end, thread) を並列実行し、全員の完了を待つ。
+    // alignment はビットマップの同じワードを複数スレッドが書かないための境界
+    template <typename Fn>
+    void parallelFor(uint64_t count, uint64_t alignment, Fn&& fn) {
+        uint64_t chunk = (count + threads_ - 1) / threads_;
+        chunk = (chunk + alignment - 1) / alignment * alignment;
+        auto task = [&fn, count, chunk](int t) {
+            uint64_t begin = t * chunk;
+            if (begin < count) {
+                fn(begin, std::min(count, begin + chunk), t);
+            }
+        };
+        run(task);
+    }
+
+private:
+    template <typename Task>
+    static void invoke(void* context, int thread) {
+        (*static_cast<Task*>(context))(thread);
+    }
+
+    template <typename Task>
+    void run(Task& task) {
+        if (threads_ == 1) {
+            task(0);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task_ = &invoke<Task>;
+            context_ = &task;
+            pending_ = threads_ - 1;
+            generation_++;
+        }
+        wake_.notify_all();
+        task(0);
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]() { return pending_ == 0; });
+    }
+
+    void work(int thread) {
+        uint64_t seen = 0;
+        while (true) {
+            void (*task)(void*, int);
+            void* context;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&]() { return generation_ != seen; });
+                seen = generation_;
+                if (stopping_) {
+                    return;
+                }
+                task = task_;
+                context = context_;
+            }
+            task(context, thread);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0) {
+                done_.notify_one();
+            }
+        }
+    }
+
+    const int threads_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    uint64_t generation_ = 0;
+    int pending_ = 0;
+    bool stopping_ = false;
+    void (*task_)(void*, int) = nullptr;
+    void* context_ = nullptr;
+};
+
+// 辺リストを持たずに済むよう、同じ乱数列で「次数を数える」「隣接配列を埋める」の2回生成する
+Graph generateRmat(int scale) {
+    const uint32_t n = 1u << scale;
+    const uint64_t m = static_cast<uint64_t>(n) * kEdgeFactor;
+    const double a = 0.57;
+    const double b = 0.19;
+    const double c = 0.19;
+
+    // 番号の偏り（小さい番号ほど高次数）を消すため頂点番号をシャッフルする
+    SplitMix64 rng{42};
+    std::vector<uint32_t> permutation(n);
+    std::iota(permutation.begin(), permutation.end(), 0u);
+    for (uint32_t i = n - 1; i > 0; i--) {
+        std::swap(permutation[i], permutation[rng.next() % (i + 1)]);
+    }
+
+    auto forEachEdge = [&](auto&& visit) {
+        SplitMix64 edgeRng{1234};
+        for (uint64_t e = 0; e < m; e++) {
+            uint32_t u = 0;
+            uint32_t v = 0;
+            for (int bit = 0; bit < scale; bit++) {
+                double r = edgeRng.uniform();
+                uint32_t mask = 1u << bit;
+                if (r < a) {
+                    continue;
+                } else if (r < a + b) {
+                    v |= mask;
+                } else if (r < a + b + c) {
+                    u |= mask;
+                } else {
+                    u |= mask;
+                    v |= mask;
+                }
+            }
+            u = permutation[u];
+            v = permutation[v];
+            if (u != v) {
+                visit(u, v);
+            }
+        }
+    };
+
+    Graph graph;
+    graph.vertices = n;
+    graph.offsets.assign(static_cast<size_t>(n) + 1, 0);
+    forEachEdge([&](uint32_t u, uint32_t v) {
+        graph.offsets[u + 1]++;
+        graph.offsets[v + 1]++;
+    });
+    std::partial_sum(graph.offsets.begin(), graph.offsets.end(), graph.offsets.begin());
+
+    graph.neighbors.resize(graph.offsets[n]);
+    std::vector<uint64_t> cursor(graph.offsets.begin(), graph.offsets.end() - 1);
+    forEachEdge([&](uint32_t u, uint32_t v) {
+        graph.neighbors[cursor[u]++] = v;
+        graph.neighbors[cursor[v]++] = u;
+    });
+    return graph;
+}
+
+// スケールが変わるまで同じグラフを使い回す（生成は計測に含めない）
+std::shared_ptr<const Graph> graphForScale(int scale) {
+    static std::mutex mutex;
+    static std::shared_ptr<const Graph> cached;
+    static int cachedScale = -1;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (cachedScale != scale) {
+        cached.reset();
+        std::cout << "Generating R-MAT graph (scale " << scale << ")..." << std::endl;
+        cached = std::make_shared<const Graph>(generateRmat(scale));
+        cachedScale = scale;
+    }
+    return cached;
+}
+
+bool testBit(const Bitmap& bitmap, uint32_t v) {
+    return (bitmap[v >> 6] >> (v & 63)) & 1;
+}
+
+void setBit(Bitmap& bitmap, uint32_t v) {
+    bitmap[v >> 6] |= uint64_t{1} << (v & 63);
+}
+
+// 戻り値は次のフロンティアの次数の合計
+uint64_t topDownStep(const Graph& graph, const std::vector<uint32_t>& frontier,
+                     std::vector<uint32_t>& next, Parents& parent, WorkerPool& pool) {
+    // スレッドごとの結果は隣り合うので、ローカルに貯めて最後に1回だけ書く（偽共有を避ける）
+    std::vector<std::vector<uint32_t>> local(pool.threads());
+    std::vector<uint64_t> degrees(pool.threads(), 0);
+    pool.parallelFor(frontier.size(), 1, [&](uint64_t begin, uint64_t end, int t) {
+        std::vector<uint32_t> found;
+        uint64_t degreeSum = 0;
+        for (uint64_t i = begin; i < end; i++) {
+            uint32_t u = frontier[i];
+            for (uint64_t e = graph.offsets[u]; e < graph.offsets[u + 1]; e++) {
+                uint32_t v = graph.neighbors[e];
+                int32_t unvisited = -1;
+                if (parent[v].load(std::memory_order_relaxed) == -1 &&
+                    parent[v].compare_exchange_strong(unvisited, static_cast<int32_t>(u),
+                                                      std::memory_order_relaxed)) {
+                    found.push_back(v);
+                    degreeSum += graph.degree(v);
+                }
+            }
+        }
+        local[t] = std::move(found);
+        degrees[t] = degreeSum;
+    });
+
+    next.clear();
+    for (const auto& part : local) {
+        next.insert(next.end(), part.begin(), part.end());
+    }
+    return std::accumulate(degrees.begin(), degrees.end(), uint64_t{0});
+}
+
+// 未訪問の頂点から親候補を探す。戻り値は {次のフロンティアの頂点数, 次数の合計}
+std::pair<uint64_t, uint64_t> bottomUpStep(const Graph& graph, const Bitmap& front, Bitmap& next,
+                                           Parents& parent, WorkerPool& pool) {
+    std::fill(next.begin(), next.end(), 0);
+    std::vector<uint64_t> counts(pool.threads(), 0);
+    std::vector<uint64_t> degrees(pool.threads(), 0);
+    pool.parallelFor(graph.vertices, 64, [&](uint64_t begin, uint64_t end, int t) {
+        uint64_t count = 0;
+        uint64_t degreeSum = 0;
+        for (uint64_t vertex = begin; vertex < end; vertex++) {
+            uint32_t v = static_cast<uint32_t>(vertex);
+            if (parent[v].load(std::memory_order_relaxed) != -1) {
+                continue;
+            }
+            for (uint64_t e = graph.offsets[v]; e < graph.offsets[v + 1]; e++) {
+                uint32_t u = graph.neighbors[e];
+                if (testBit(front, u)) {
+                    parent[v].store(static_cast<int32_t>(u), std::memory_order_relaxed);
+                    setBit(next, v);
+                    count++;
+                    degreeSum += graph.degree(v);
+                    break;
+                }
+            }
+        }
+        counts[t] = count;
+        degrees[t] = degreeSum;
+    });
+    return {std::accumulate(counts.begin(), counts.end(), uint64_t{0}),
+            std::accumulate(degrees.begin(), degrees.end(), uint64_t{0})};
+}
+
+void runBfs(const Graph& graph, uint32_t root, bool directionOptimizing, WorkerPool& pool, Parents& parent) {
+    const uint32_t n = graph.vertices;
+    pool.parallelFor(n, 1, [&](uint64_t begin, uint64_t end, int) {
+        for (uint64_t v = begin; v < end; v++) {
+            parent[v].store(-1, std::memory_order_relaxed);
+        }
+    });
+    parent[root].store(static_cast<int32_t>(root));
+
+    std::vector<uint32_t> frontier = {root};
+    std::vector<uint32_t> next;
+    Bitmap front;
+    Bitmap nextBits;
+    uint64_t frontierEdges = graph.degree(root);
+    uint64_t unexploredEdges = graph.neighbors.size() - frontierEdges;
+    uint64_t previousCount = 1;
+    bool bottomUp = false;
+
+    while (true) {
+        if (!bottomUp) {
+            if (frontier.empty()) {
+                break;
+            }
+            if (directionOptimizing && frontierEdges > unexploredEdges / kAlpha) {
+                front.assign(n / 64 + 1, 0);
+                nextBits.assign(n / 64 + 1, 0);
+                for (uint32_t v : frontier) {
+                    setBit(front, v);
+                }
+                previousCount = frontier.size();
+                bottomUp = true;
+                continue;
+            }
+            frontierEdges = topDownStep(graph, frontier, next, parent, pool);
+            unexploredEdges -= std::min(unexploredEdges, frontierEdges);
+            frontier.swap(next);
+        } else {
+            auto step = bottomUpStep(graph, front, nextBits, parent, pool);
+            front.swap(nextBits);
+            frontierEdges = step.second;
+            unexploredEdges -= std::min(unexploredEdges, frontierEdges);
+            if (step.first == 0) {
+                break;
+            }
+            // フロンティアが小さくなり縮小中ならトップダウンに戻す
+            if (step.first < n / kBeta && step.first < previousCount) {
+                frontier.clear();
+                for (uint32_t v = 0; v < n; v++) {
+                    if (testBit(front, v)) {
+                        frontier.push_back(v);
+                    }
+                }
+                bottomUp = false;
+            }
+            previousCount = step.first;
+        }
+    }
+}
+
+// Graph500 と同じく、到達した連結成分内の辺数を走査辺数とする
+uint64_t traversedEdges(const Graph& graph, const Parents& parent, uint64_t& reached) {
+    uint64_t degreeSum = 0;
+    reached = 0;
+    for (uint32_t v = 0; v < graph.vertices; v++) {
+        if (parent[v].load(std::memory_order_relaxed) != -1) {
+            degreeSum += graph.degree(v);
+            reached++;
+        }
+    }
+    return degreeSum / 2;
+}
+
+std::vector<uint32_t> pickRoots(const Graph& graph) {
+    SplitMix64 rng{7};
+    std::vector<uint32_t> roots;
+    for (int attempt = 0; attempt < 1000 && roots.size() < static_cast<size_t>(kBfsRoots); attempt++) {
+        uint32_t v = static_cast<uint32_t>(rng.next() % graph.vertices);
+        if (graph.degree(v) > 0) {
+            roots.push_back(v);
+        }
+    }
+    return roots;
+}
+
+std::string describe(int scale, int threads) {
+    return "2^" + std::to_string(scale) + " vertices, " + std::to_string(threads) +
+        (threads == 1 ? " thread" : " threads");
+}
+
+}
+
+const std::vector<BenchmarkCase>& GraphBenchmark::registeredBenchmarks() {
+    static const std::vector<BenchmarkCase> cases = []() {
+        std::vector<BenchmarkCase> list;
+        size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        // ワーカーを作りすぎないよう 1〜ハードウェアスレッド数の4倍に収める
+        size_t requestedThreads = Benchmark::sizesFromEnv("BENCHMARK_GRAPH_THREADS", {hardwareThreads})[0];
+        size_t maxThreads = hardwareThreads * kMaxThreadsPerHardwareThread;
+        size_t clampedThreads = std::max<size_t>(1, std::min(requestedThreads, maxThreads));
+        if (clampedThreads != requestedThreads) {
+            std::cerr << "BENCHMARK_GRAPH_THREADS=" << requestedThreads << " is out of range; using "
+                      << clampedThreads << std::endl;
+        }
+        int parallelThreads = static_cast<int>(clampedThreads);
+        std::vector<int> threadCounts = {1};
+        if (parallelThreads > 1) {
+            threadCounts.push_back(parallelThreads);
+        }
+
+        // 小さすぎるとスレッド起動や根の選択が支配的になる（次数 0 だけのグラフもありうる）
+        std::vector<int> scales;
+        for (size_t scaleValue : Benchmark::sizesFromEnv("BENCHMARK_GRAPH_SCALES", {16, 20})) {
+            int scale = static_cast<int>(std::max<size_t>(kMinScale, std::min<size_t>(scaleValue, kMaxScale)));
+            if (std::find(scales.begin(), scales.end(), scale) == scales.end()) {
+                scales.push_back(scale);
+            }
+        }
+        for (int scale : scales) {
+            std::string suffix = "-s" + std::to_string(scale);
+            for (int threads : threadCounts) {
+                std::string threadSuffix = "-" + std::to_string(threads) + "t";
+                list.push_back({"bfs-td" + suffix + threadSuffix, "graph",
+                                [scale, threads]() { return benchmarkBfs(scale, false, threads); }});
+                list.push_back({"bfs-do" + suffix + threadSuffix, "graph",
+                                [scale, threads]() { return benchmarkBfs(scale, true, threads); }});
+                list.push_back({"pagerank" + suffix + threadSuffix, "graph",
+                                [scale, threads]() { return benchmarkPageRank(scale, threads); }});
+            }
+        }
+        return list;
+    }();
+    return cases;
+}
+
+BenchmarkResult GraphBenchmark::benchmarkBfs(int scale, bool directionOptimizing, int threads) {
+    auto graph = graphForScale(scale);
+    std::vector<uint32_t> roots = pickRoots(*graph);
+    Parents parent(graph->vertices);
+    std::string name = std::string(directionOptimizing ? "BFS Direction-Optimizing" : "BFS Top-Down") +
+        " (" + describe(scale, threads) + ")";
+    if (roots.empty()) {
+        std::cout << "No vertex with edges to start BFS from" << std::endl;
+        return BenchmarkResult(name, 0, 0, 0, 0.0);
+    }
+
+    // スレッドの起動は計測の外で1回だけ行う
+    WorkerPool pool(threads);
+    WorkerPool serial(1);
+    long long totalNs = 0;
+    uint64_t totalEdges = 0;
+    for (size_t i = 0; i < roots.size(); i++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        runBfs(*graph, roots[i], directionOptimizing, pool, parent);
+        auto end = std::chrono::high_resolution_clock::now();
+        totalNs += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+        uint64_t reached = 0;
+        totalEdges += traversedEdges(*graph, parent, reached);
+
+        // 最初の根だけ逐次トップダウンと到達頂点数を突き合わせる
+        if (i == 0 && (directionOptimizing || threads > 1)) {
+            Parents reference(graph->vertices);
+            runBfs(*graph, roots[i], false, serial, reference);
+            uint64_t referenceReached = 0;
+            traversedEdges(*graph, reference, referenceReached);
+            if (reached != referenceReached) {
+                std::cout << "BFS reached " << reached << " vertices, expected " << referenceReached << std::endl;
+            }
+        }
+    }
+
+    double durationSeconds = totalNs / 1e9;
+    double teps = totalEdges / durationSeconds;
+    long long memory = graph->bytes() + static_cast<long long>(parent.size() * sizeof(int32_t));
+    BenchmarkResult result(name, totalNs, memory, static_cast<long long>(totalEdges), teps);
+    result.metrics = {
+        {"teps", teps},
+        {"mean_ms_per_search", totalNs / 1e6 / roots.size()},
+        {"vertices", static_cast<double>(graph->vertices)},
+        {"edges", static_cast<double>(graph->neighbors.size() / 2)},
+        {"threads", static_cast<double>(threads)},
+    };
+    return result;
+}
+
+BenchmarkResult GraphBenchmark::benchmarkPageRank(int scale, int threads) {
+    auto graph = graphForScale(scale);
+    const uint32_t n = graph->vertices;
+    std::vector<double> rank(n, 1.0 / n);
+    std::vector<double> next(n);
+    std::vector<double> contribution(n);
+    WorkerPool pool(threads);
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // プル型: 各頂点が隣接頂点の寄与を集める（書き込みの競合がない）
+    for (int iteration = 0; iteration < kPageRankIterations; iteration++) {
+        std::vector<double> dangling(threads, 0.0);
+        pool.parallelFor(n, 1, [&](uint64_t begin, uint64_t end, int t) {
+            double danglingSum = 0.0;
+            for (uint64_t u = begin; u < end; u++) {
+                uint64_t degree = graph->degree(static_cast<uint32_t>(u));
+                contribution[u] = degree > 0 ? rank[u] / degree : 0.0;
+                if (degree == 0) {
+                    danglingSum += rank[u];
+                }
+            }
+            dangling[t] = danglingSum;
+        });
+        double base = (1.0 - kDamping) / n +
+            kDamping * std::accumulate(dangling.begin(), dangling.end(), 0.0) / n;
+
+        pool.parallelFor(n, 1, [&](uint64_t begin, uint64_t end, int) {
+            for (uint64_t v = begin; v < end; v++) {
+                double sum = 0.0;
+                for (uint64_t e = graph->offsets[v]; e < graph->offsets[v + 1]; e++) {
+                    sum += contribution[graph->neighbors[e]];
+                }
+                next[v] = base + kDamping * sum;
+            }
+        });
+        rank.swap(next);
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    double durationSeconds = duration / 1e9;
+
+    double total = std::accumulate(rank.begin(), rank.end(), 0.0);
+    if (std::abs(total - 1.0) > 1e-6) {
+        std::cout << "PageRank does not sum to 1: " << total << std::endl;
+    }
+
+    long long edgesProcessed = static_cast<long long>(graph->neighbors.size()) * kPageRankIterations;
+    double teps = edgesProcessed / durationSeconds;
+    long long memory = graph->bytes() + static_cast<long long>(3 * n * sizeof(double));
+    BenchmarkResult result("PageRank " + std::to_string(kPageRankIterations) + " iterations (" +
+                               describe(scale, threads) + ")",
+                           duration, memory, edgesProcessed, teps);
+    result.metrics = {
+        {"teps", teps},
+        {"vertices", static_cast<double>(n)},
+        {"edges", static_cast<double>(graph->neighbors.size() / 2)},
+        {"threads", static_cast<double>(threads)},
+    };
+    return result;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "benchmark.h"
+#include <vector>
+
+// R-MAT（Graph500 と同じ a=0.57, b=c=0.19）で生成した無向グラフを CSR で持ち、
+// BFS（トップダウン / 方向最適化）と PageRank の TEPS を測る。
+//   BENCHMARK_GRAPH_SCALES   頂点数 2^scale のリスト（既定 "16,20"、16〜26 に丸める）
+//   BENCHMARK_GRAPH_THREADS  並列版のスレッド数（既定は論理CPU数。1 なら並列版は省略）
+class GraphBenchmark {
+public:
+    static const std::vector<BenchmarkCase>& registeredBenchmarks();
+
+private:
+    static BenchmarkResult benchmarkBfs(int scale, bool directionOptimizing, int threads);
+    static BenchmarkResult benchmarkPageRank(int scale, int threads);
+};
\ No newline at end of file
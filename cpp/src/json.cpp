@@ -0,0 +1,671 @@
+#include "json.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define JSON_SIMD_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define JSON_SIMD_NEON 1
+#endif
+
+namespace {
+
+const int kMaxDepth = 1024;
+
+// ---- ライタ用 ----
+
+bool needsEscape(unsigned char c) {
+    return c == '"' || c == '\\' || c < 0x20;
+}
+
+// ---- ステージ1: 構造文字の位置 ----
+
+struct BlockMasks {
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t op;          // { } [ ] : ,
+    uint64_t whitespace;
+};
+
+#if defined(JSON_SIMD_SSE2)
+
+BlockMasks classifyBlock(const char* block) {
+    BlockMasks masks = {0, 0, 0, 0};
+    for (int i = 0; i < 4; i++) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+        // '[' ']' は 0x20 を立てると '{' '}' になる
+        __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        auto bits = [i](__m128i matches) {
+            return static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(matches))) << (16 * i);
+        };
+        masks.quote |= bits(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')));
+        masks.backslash |= bits(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+        masks.op |= bits(_mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')), _mm_cmpeq_epi8(folded, _mm_set1_epi8('}'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')), _mm_cmpeq_epi8(v, _mm_set1_epi8(',')))));
+        masks.whitespace |= bits(_mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r')))));
+    }
+    return masks;
+}
+
+#elif defined(JSON_SIMD_NEON)
+
+uint64_t movemask(uint8x16_t m0, uint8x16_t m1, uint8x16_t m2, uint8x16_t m3) {
+    const uint8x16_t weights = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
+                                0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80};
+    uint8x16_t sum0 = vpaddq_u8(vandq_u8(m0, weights), vandq_u8(m1, weights));
+    uint8x16_t sum1 = vpaddq_u8(vandq_u8(m2, weights), vandq_u8(m3, weights));
+    sum0 = vpaddq_u8(sum0, sum1);
+    sum0 = vpaddq_u8(sum0, sum0);
+    return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+}
+
+BlockMasks classifyBlock(const char* block) {
+    uint8x16_t v[4];
+    for (int i = 0; i < 4; i++) {
+        v[i] = vld1q_u8(reinterpret_cast<const uint8_t*>(block + 16 * i));
+    }
+    auto mask = [&v](auto&& match) { return movemask(match(v[0]), match(v[1]), match(v[2]), match(v[3])); };
+
+    BlockMasks masks;
+    masks.quote = mask([](uint8x16_t x) { return vceqq_u8(x, vdupq_n_u8('"')); });
+    masks.backslash = mask([](uint8x16_t x) { return vceqq_u8(x, vdupq_n_u8('\\')); });
+    masks.op = mask([](uint8x16_t x) {
+        uint8x16_t folded = vorrq_u8(x, vdupq_n_u8(0x20));
+        return vorrq_u8(vorrq_u8(vceqq_u8(folded, vdupq_n_u8('{')), vceqq_u8(folded, vdupq_n_u8('}'))),
+                        vorrq_u8(vceqq_u8(x, vdupq_n_u8(':')), vceqq_u8(x, vdupq_n_u8(','))));
+    });
+    masks.whitespace = mask([](uint8x16_t x) {
+        return vorrq_u8(vorrq_u8(vceqq_u8(x, vdupq_n_u8(' ')), vceqq_u8(x, vdupq_n_u8('\t'))),
+                        vorrq_u8(vceqq_u8(x, vdupq_n_u8('\n')), vceqq_u8(x, vdupq_n_u8('\r'))));
+    });
+    return masks;
+}
+
+#else
+
+BlockMasks classifyBlock(const char* block) {
+    BlockMasks masks = {0, 0, 0, 0};
+    for (int i = 0; i < 64; i++) {
+        uint64_t bit = uint64_t{1} << i;
+        switch (block[i]) {
+            case '"': masks.quote |= bit; break;
+            case '\\': masks.backslash |= bit; break;
+            case '{': case '}': case '[': case ']': case ':': case ',': masks.op |= bit; break;
+            case ' ': case '\t': case '\n': case '\r': masks.whitespace |= bit; break;
+            default: break;
+        }
+    }
+    return masks;
+}
+
+#endif
+
+// 奇数個のバックスラッシュ列の直後（＝エスケープされた文字）のビット。simdjson と同じ手法
+uint64_t findEscaped(uint64_t backslash, uint64_t& previousEndsOdd) {
+    if (backslash == 0) {
+        uint64_t escaped = previousEndsOdd;
+        previousEndsOdd = 0;
+        return escaped;
+    }
+    const uint64_t evenBits = 0x5555555555555555ULL;
+    const uint64_t oddBits = ~evenBits;
+    uint64_t startEdges = backslash & ~(backslash << 1);
+    uint64_t evenStartMask = evenBits ^ previousEndsOdd;
+    uint64_t evenStarts = startEdges & evenStartMask;
+    uint64_t oddStarts = startEdges & ~evenStartMask;
+    uint64_t evenCarries = backslash + evenStarts;
+    uint64_t oddCarries = backslash + oddStarts;
+    bool endsOdd = oddCarries < backslash;
+    oddCarries |= previousEndsOdd;
+    previousEndsOdd = endsOdd ? 1 : 0;
+    uint64_t evenCarryEnds = evenCarries & ~backslash;
+    uint64_t oddCarryEnds = oddCarries & ~backslash;
+    return (evenCarryEnds & oddBits) | (oddCarryEnds & evenBits);
+}
+
+// 各ビットより下位のビットの XOR（開き引用符から閉じ引用符の手前までが 1 になる）
+uint64_t prefixXor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+void indexSimd(std::string_view json, std::vector<uint32_t>& indexes) {
+    uint64_t previousEndsOdd = 0;
+    uint64_t previousInString = 0;
+    uint64_t previousScalar = 0;
+    char padded[64];
+
+    for (size_t offset = 0; offset < json.size(); offset += 64) {
+        const char* block = json.data() + offset;
+        if (json.size() - offset < 64) {
+            std::memset(padded, ' ', sizeof(padded));
+            std::memcpy(padded, block, json.size() - offset);
+            block = padded;
+        }
+
+        BlockMasks masks = classifyBlock(block);
+        uint64_t escaped = findEscaped(masks.backslash, previousEndsOdd);
+        uint64_t quotes = masks.quote & ~escaped;
+        uint64_t inString = prefixXor(quotes) ^ previousInString;
+        previousInString = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+
+        // 文字列外のスカラー（数値・true など）は先頭の1文字だけを構造位置にする
+        uint64_t scalar = ~(masks.op | masks.whitespace | quotes) & ~inString;
+        uint64_t scalarStarts = scalar & ~((scalar << 1) | previousScalar);
+        previousScalar = scalar >> 63;
+
+        uint64_t structurals = (masks.op & ~inString) | (quotes & inString) | scalarStarts;
+        while (structurals != 0) {
+            indexes.push_back(static_cast<uint32_t>(offset + __builtin_ctzll(structurals)));
+            structurals &= structurals - 1;
+        }
+    }
+
+    if (previousInString != 0) {
+        throw std::runtime_error("JSON parse error: unterminated string");
+    }
+}
+
+void indexScalar(std::string_view json, std::vector<uint32_t>& indexes) {
+    bool inString = false;
+    bool escaped = false;
+    bool inScalar = false;
+
+    for (size_t i = 0; i < json.size(); i++) {
+        char c = json[i];
+        // バックスラッシュ列の奇偶は文字列の外でも追う（SIMD 版と同じ位置を返すため）
+        bool escapedHere = escaped;
+        escaped = c == '\\' && !escapedHere;
+        if (inString) {
+            if (c == '"' && !escapedHere) {
+                inString = false;
+            }
+            continue;
+        }
+        if (c == '"' && !escapedHere) {
+            indexes.push_back(static_cast<uint32_t>(i));
+            inString = true;
+            inScalar = false;
+            continue;
+        }
+        switch (c) {
+            case '{': case '}': case '[': case ']': case ':': case ',':
+                indexes.push_back(static_cast<uint32_t>(i));
+                inScalar = false;
+                break;
+            case ' ': case '\t': case '\n': case '\r':
+                inScalar = false;
+                break;
+            default:
+                if (!inScalar) {
+                    indexes.push_back(static_cast<uint32_t>(i));
+                    inScalar = true;
+                }
+                break;
+        }
+    }
+
+    if (inString) {
+        throw std::runtime_error("JSON parse error: unterminated string");
+    }
+}
+
+// ---- ステージ2: 構造位置を辿ってテープを組む ----
+
+class TapeBuilder {
+public:
+    TapeBuilder(std::string_view json, const std::vector<uint32_t>& indexes,
+                std::vector<JsonTapeEntry>& tape, std::string& strings)
+        : json_(json), indexes_(indexes), tape_(tape), strings_(strings) {}
+
+    void parseDocument() {
+        parseValue(0);
+        if (position_ != indexes_.size()) {
+            error(indexes_[position_], "trailing content");
+        }
+    }
+
+private:
+    [[noreturn]] void error(size_t at, const char* message) const {
+        throw std::runtime_error("JSON parse error at byte " + std::to_string(at) + ": " + message);
+    }
+
+    size_t current() const {
+        if (position_ >= indexes_.size()) {
+            error(json_.size(), "unexpected end of input");
+        }
+        return indexes_[position_];
+    }
+
+    bool isDelimiter(size_t at) const {
+        if (at >= json_.size()) {
+            return true;
+        }
+        char c = json_[at];
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == ',' || c == ':' ||
+               c == ']' || c == '}' || c == '[' || c == '{';
+    }
+
+    void parseValue(int depth) {
+        if (depth > kMaxDepth) {
+            error(current(), "nesting too deep");
+        }
+        size_t at = current();
+        switch (json_[at]) {
+            case '{': parseObject(depth); break;
+            case '[': parseArray(depth); break;
+            case '"': parseString(at); break;
+            case 't': parseLiteral(at, "true", JsonType::True); break;
+            case 'f': parseLiteral(at, "false", JsonType::False); break;
+            case 'n': parseLiteral(at, "null", JsonType::Null); break;
+            default: parseNumber(at); break;
+        }
+    }
+
+    void parseObject(int depth) {
+        size_t self = tape_.size();
+        tape_.push_back({JsonType::Object, 0, 0, 0, 0.0});
+        position_++;
+        if (json_[current()] == '}') {
+            position_++;
+        } else {
+            while (true) {
+                size_t at = current();
+                if (json_[at] != '"') {
+                    error(at, "expected object key");
+                }
+                parseString(at);
+                if (json_[current()] != ':') {
+                    error(current(), "expected ':'");
+                }
+                position_++;
+                parseValue(depth + 1);
+                at = current();
+                position_++;
+                if (json_[at] == '}') {
+                    break;
+                }
+                if (json_[at] != ',') {
+                    error(at, "expected ',' or '}'");
+                }
+            }
+        }
+        tape_[self].end = static_cast<uint32_t>(tape_.size());
+    }
+
+    void parseArray(int depth) {
+        size_t self = tape_.size();
+        tape_.push_back({JsonType::Array, 0, 0, 0, 0.0});
+        position_++;
+        if (json_[current()] == ']') {
+            position_++;
+        } else {
+            while (true) {
+                parseValue(depth + 1);
+                size_t at = current();
+                position_++;
+                if (json_[at] == ']') {
+                    break;
+                }
+                if (json_[at] != ',') {
+                    error(at, "expected ',' or ']'");
+                }
+            }
+        }
+        tape_[self].end = static_cast<uint32_t>(tape_.size());
+    }
+
+    void parseLiteral(size_t at, std::string_view literal, JsonType type) {
+        if (json_.compare(at, literal.size(), literal) != 0 || !isDelimiter(at + literal.size())) {
+            error(at, "invalid literal");
+        }
+        tape_.push_back({type, 0, 0, 0, 0.0});
+        position_++;
+    }
+
+    // JSON の数値文法: -? (0 | [1-9][0-9]*) (. [0-9]+)? ([eE] [+-]? [0-9]+)?
+    // from_chars は inf / nan / 先頭の 0 / "1." も受け付けるので先に形を確かめる
+    size_t scanNumber(size_t at) const {
+        size_t i = at;
+        auto digit = [this](size_t p) { return p < json_.size() && json_[p] >= '0' && json_[p] <= '9'; };
+        if (i < json_.size() && json_[i] == '-') {
+            i++;
+        }
+        if (!digit(i)) {
+            return std::string_view::npos;
+        }
+        if (json_[i] == '0') {
+            i++;
+        } else {
+            while (digit(i)) {
+                i++;
+            }
+        }
+        if (i < json_.size() && json_[i] == '.') {
+            i++;
+            if (!digit(i)) {
+                return std::string_view::npos;
+            }
+            while (digit(i)) {
+                i++;
+            }
+        }
+        if (i < json_.size() && (json_[i] == 'e' || json_[i] == 'E')) {
+            i++;
+            if (i < json_.size() && (json_[i] == '+' || json_[i] == '-')) {
+                i++;
+            }
+            if (!digit(i)) {
+                return std::string_view::npos;
+            }
+            while (digit(i)) {
+                i++;
+            }
+        }
+        return i;
+    }
+
+    void parseNumber(size_t at) {
+        size_t end = scanNumber(at);
+        if (end == std::string_view::npos || !isDelimiter(end)) {
+            error(at, "invalid number");
+        }
+        double number = 0.0;
+        auto parsed = std::from_chars(json_.data() + at, json_.data() + end, number);
+        if (parsed.ec != std::errc() || parsed.ptr != json_.data() + end) {
+            error(at, "number out of range");
+        }
+        tape_.push_back({JsonType::Number, 0, 0, 0, number});
+        position_++;
+    }
+
+    void appendUtf8(uint32_t codePoint) {
+        if (codePoint < 0x80) {
+            strings_ += static_cast<char>(codePoint);
+        } else if (codePoint < 0x800) {
+            strings_ += static_cast<char>(0xC0 | (codePoint >> 6));
+            strings_ += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else if (codePoint < 0x10000) {
+            strings_ += static_cast<char>(0xE0 | (codePoint >> 12));
+            strings_ += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            strings_ += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else {
+            strings_ += static_cast<char>(0xF0 | (codePoint >> 18));
+            strings_ += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            strings_ += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            strings_ += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+
+    uint32_t parseHex4(size_t at) const {
+        uint32_t value = 0;
+        if (at + 4 > json_.size()) {
+            error(at, "truncated \\u escape");
+        }
+        auto parsed = std::from_chars(json_.data() + at, json_.data() + at + 4, value, 16);
+        if (parsed.ptr != json_.data() + at + 4) {
+            error(at, "invalid \\u escape");
+        }
+        return value;
+    }
+
+    void parseString(size_t at) {
+        size_t offset = strings_.size();
+        size_t i = at + 1;
+        while (true) {
+            // エスケープのない区間はまとめてコピーする
+            size_t run = i;
+            while (run < json_.size() && json_[run] != '"' && json_[run] != '\\' &&
+                   static_cast<unsigned char>(json_[run]) >= 0x20) {
+                run++;
+            }
+            strings_.append(json_.data() + i, run - i);
+            if (run >= json_.size()) {
+                error(at, "unterminated string");
+            }
+            // 文字列中の制御文字はエスケープ必須
+            if (static_cast<unsigned char>(json_[run]) < 0x20) {
+                error(run, "control character in string");
+            }
+            if (json_[run] == '"') {
+                i = run + 1;
+                break;
+            }
+
+            char escape = run + 1 < json_.size() ? json_[run + 1] : '\0';
+            i = run + 2;
+            switch (escape) {
+                case '"': strings_ += '"'; break;
+                case '\\': strings_ += '\\'; break;
+                case '/': strings_ += '/'; break;
+                case 'b': strings_ += '\b'; break;
+                case 'f': strings_ += '\f'; break;
+                case 'n': strings_ += '\n'; break;
+                case 'r': strings_ += '\r'; break;
+                case 't': strings_ += '\t'; break;
+                case 'u': {
+                    uint32_t codePoint = parseHex4(i);
+                    i += 4;
+                    if (codePoint >= 0xD800 && codePoint < 0xDC00 &&
+                        i + 1 < json_.size() && json_[i] == '\\' && json_[i + 1] == 'u') {
+                        uint32_t low = parseHex4(i + 2);
+                        if (low >= 0xDC00 && low < 0xE000) {
+                            codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                            i += 6;
+                        }
+                    }
+                    appendUtf8(codePoint);
+                    break;
+                }
+                default:
+                    error(run, "invalid escape");
+            }
+        }
+        tape_.push_back({JsonType::String, 0, static_cast<uint32_t>(offset),
+                         static_cast<uint32_t>(strings_.size() - offset), 0.0});
+        position_++;
+    }
+
+    std::string_view json_;
+    const std::vector<uint32_t>& indexes_;
+    std::vector<JsonTapeEntry>& tape_;
+    std::string& strings_;
+    size_t position_ = 0;
+};
+
+}
+
+// ---- JsonWriter ----
+
+JsonWriter::JsonWriter(size_t capacity) : buffer_(std::max<size_t>(capacity, 64)) {
+    first_.reserve(32);
+}
+
+void JsonWriter::clear() {
+    size_ = 0;
+    first_.clear();
+    afterKey_ = false;
+}
+
+char* JsonWriter::reserve(size_t bytes) {
+    if (size_ + bytes > buffer_.size()) {
+        buffer_.resize(std::max(buffer_.size() * 2, size_ + bytes));
+    }
+    return buffer_.data() + size_;
+}
+
+void JsonWriter::append(const char* data, size_t bytes) {
+    std::memcpy(reserve(bytes), data, bytes);
+    size_ += bytes;
+}
+
+void JsonWriter::separator() {
+    if (afterKey_) {
+        afterKey_ = false;
+        return;
+    }
+    if (!first_.empty()) {
+        if (first_.back()) {
+            first_.back() = 0;
+        } else {
+            append(",", 1);
+        }
+    }
+}
+
+void JsonWriter::appendEscaped(std::string_view text) {
+    // 最悪ケース（全文字 \u00XX）でも足りる分を先に確保する
+    char* out = reserve(text.size() * 6 + 2);
+    char* start = out;
+    *out++ = '"';
+    for (char c : text) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if (!needsEscape(byte)) {
+            *out++ = c;
+            continue;
+        }
+        *out++ = '\\';
+        switch (c) {
+            case '"': *out++ = '"'; break;
+            case '\\': *out++ = '\\'; break;
+            case '\n': *out++ = 'n'; break;
+            case '\r': *out++ = 'r'; break;
+            case '\t': *out++ = 't'; break;
+            case '\b': *out++ = 'b'; break;
+            case '\f': *out++ = 'f'; break;
+            default: {
+                static const char hex[] = "0123456789abcdef";
+                *out++ = 'u';
+                *out++ = '0';
+                *out++ = '0';
+                *out++ = hex[byte >> 4];
+                *out++ = hex[byte & 0xF];
+                break;
+            }
+        }
+    }
+    *out++ = '"';
+    size_ += static_cast<size_t>(out - start);
+}
+
+void JsonWriter::beginObject() {
+    separator();
+    append("{", 1);
+    first_.push_back(1);
+}
+
+void JsonWriter::endObject() {
+    first_.pop_back();
+    append("}", 1);
+}
+
+void JsonWriter::beginArray() {
+    separator();
+    append("[", 1);
+    first_.push_back(1);
+}
+
+void JsonWriter::endArray() {
+    first_.pop_back();
+    append("]", 1);
+}
+
+void JsonWriter::key(std::string_view name) {
+    separator();
+    appendEscaped(name);
+    append(":", 1);
+    afterKey_ = true;
+}
+
+void JsonWriter::value(std::string_view text) {
+    separator();
+    appendEscaped(text);
+}
+
+void JsonWriter::value(long long number) {
+    separator();
+    char* out = reserve(24);
+    size_ = static_cast<size_t>(std::to_chars(out, out + 24, number).ptr - buffer_.data());
+}
+
+void JsonWriter::value(double number) {
+    if (!std::isfinite(number)) {
+        null();
+        return;
+    }
+    separator();
+    char* out = reserve(32);
+    size_ = static_cast<size_t>(std::to_chars(out, out + 32, number).ptr - buffer_.data());
+}
+
+void JsonWriter::value(double number, int precision) {
+    if (!std::isfinite(number)) {
+        null();
+        return;
+    }
+    separator();
+    // fixed 表記は最大 309 桁の整数部を持ちうる
+    size_t capacity = 330 + static_cast<size_t>(precision);
+    char* out = reserve(capacity);
+    auto written = std::to_chars(out, out + capacity, number, std::chars_format::fixed, precision);
+    size_ = static_cast<size_t>(written.ptr - buffer_.data());
+}
+
+void JsonWriter::value(bool flag) {
+    separator();
+    if (flag) {
+        append("true", 4);
+    } else {
+        append("false", 5);
+    }
+}
+
+void JsonWriter::null() {
+    separator();
+    append("null", 4);
+}
+
+// ---- JsonDocument ----
+
+bool JsonDocument::simdAvailable() {
+#if defined(JSON_SIMD_SSE2) || defined(JSON_SIMD_NEON)
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::vector<uint32_t> JsonDocument::structuralIndexes(std::string_view json, Stage1 stage1) {
+    if (json.size() > UINT32_MAX) {
+        throw std::runtime_error("JSON parse error: document larger than 4GB");
+    }
+    std::vector<uint32_t> indexes;
+    indexes.reserve(json.size() / 8);
+    if (stage1 == Stage1::Simd) {
+        indexSimd(json, indexes);
+    } else {
+        indexScalar(json, indexes);
+    }
+    return indexes;
+}
+
+JsonDocument JsonDocument::parse(std::string_view json, Stage1 stage1) {
+    std::vector<uint32_t> indexes = structuralIndexes(json, stage1);
+    JsonDocument document;
+    document.tape_.reserve(indexes.size());
+    TapeBuilder(json, indexes, document.tape_, document.strings_).parseDocument();
+    return document;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 事前確保したバッファに to_chars で直接書き出す JSON ライタ（インデントなし）
+class JsonWriter {
+public:
+    explicit JsonWriter(size_t capacity = 1 << 16);
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+    void key(std::string_view name);
+
+    void value(std::string_view text);
+    void value(const char* text) { value(std::string_view(text)); }
+    void value(long long number);
+    void value(double number);                 // 最短表現
+    void value(double number, int precision);  // 小数点以下 precision 桁（std::fixed 相当）
+    void value(bool flag);
+    void null();
+
+    std::string_view view() const { return std::string_view(buffer_.data(), size_); }
+    void clear();
+
+private:
+    void separator();
+    char* reserve(size_t bytes);
+    void append(const char* data, size_t bytes);
+    void appendEscaped(std::string_view text);
+
+    std::vector<char> buffer_;
+    size_t size_ = 0;
+    std::vector<char> first_;  // ネストごとの「まだ要素がない」フラグ
+    bool afterKey_ = false;
+};
+
+enum class JsonType : uint8_t {
+    Null,
+    False,
+    True,
+    Number,
+    String,
+    Array,
+    Object,
+};
+
+// パース結果は simdjson と同様のテープ（深さ優先の平坦な配列）。
+// コンテナの end は対応する子要素の直後のテープ位置、文字列は strings() 内の位置
+struct JsonTapeEntry {
+    JsonType type;
+    uint32_t end;
+    uint32_t offset;
+    uint32_t length;
+    double number;
+};
+
+// 2段階パーサ: (1) 64バイト単位の SIMD 分類で構造文字の位置を列挙し、(2) その位置だけを辿ってテープを組む
+class JsonDocument {
+public:
+    enum class Stage1 {
+        Simd,    // SSE2 / NEON（どちらもなければスカラーにフォールバック）
+        Scalar,  // 1バイトずつの状態機械
+    };
+
+    // 不正な JSON は std::runtime_error
+    static JsonDocument parse(std::string_view json, Stage1 stage1 = Stage1::Simd);
+    static std::vector<uint32_t> structuralIndexes(std::string_view json, Stage1 stage1);
+    static bool simdAvailable();
+
+    const std::vector<JsonTapeEntry>& tape() const { return tape_; }
+    std::string_view string(const JsonTapeEntry& entry) const {
+        return std::string_view(strings_.data() + entry.offset, entry.length);
+    }
+
+private:
+    std::vector<JsonTapeEntry> tape_;
+    std::string strings_;
+};
@@ -0,0 +1,378 @@
+#include "json_benchmark.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+const int kRepetitions = 5;
+const char* const kResultsDocument = "results";
+const char* const kSampleDocument = "sample";
+// JsonWriter::reserve は文字列長の6倍など最悪ケースで要求するので、末尾付近で拡張しないよう余裕を足す
+const size_t kWriterSlack = 4096;
+
+const char* const kTestNames[] = {
+    "Prime Numbers", "Matrix Multiplication", "Cryptographic Hashing",
+    "行列乗算 \"100x100\"", "String\tConcatenation",
+};
+const char* const kMetricNames[] = {"teps", "slowdown", "gb_per_sec"};
+
+std::vector<BenchmarkResult> syntheticResults(size_t count) {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<long long> integer(1000, 5000000000LL);
+    std::uniform_real_distribution<double> real(0.0, 1e7);
+
+    std::vector<BenchmarkResult> results;
+    results.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        BenchmarkResult result(std::string(kTestNames[i % 5]) + " #" + std::to_string(i),
+                               integer(rng), integer(rng) / 7, integer(rng) / 3, real(rng));
+        for (size_t m = 0; m < i % 4; m++) {
+            result.metrics.push_back({kMetricNames[m], real(rng) / 1000});
+        }
+        results.push_back(std::move(result));
+    }
+    return results;
+}
+
+const std::vector<BenchmarkResult>& resultsForDocument() {
+    static const std::vector<BenchmarkResult> results =
+        syntheticResults(Benchmark::sizesFromEnv("BENCHMARK_JSON_ENTRIES", {100000})[0]);
+    return results;
+}
+
+void writeEscaped(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            case '\b': out << "\\b"; break;
+            case '\f': out << "\\f"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out << "\\u00" << std::hex << std::setw(2) << std::setfill('0')
+                        << static_cast<int>(c) << std::dec << std::setfill(' ');
+                } else {
+                    out << c;
+                }
+                break;
+        }
+    }
+    out << '"';
+}
+
+// Output::saveResultsToJSON と同じ書き方（インデントなし）
+void serializeWithStream(std::ostream& out, const std::vector<BenchmarkResult>& results) {
+    out << "{\"language\":\"C++\",\"tests\":[";
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto& result = results[i];
+        out << (i == 0 ? "{\"test\":" : ",{\"test\":");
+        writeEscaped(out, result.test);
+        out << ",\"duration_ns\":" << result.duration_ns
+            << ",\"memory_bytes\":" << result.memory_bytes
+            << ",\"operations\":" << result.operations
+            << ",\"ops_per_sec\":" << std::fixed << std::setprecision(2) << result.ops_per_sec;
+        if (!result.metrics.empty()) {
+            out << ",\"metrics\":{";
+            for (size_t m = 0; m < result.metrics.size(); m++) {
+                out << (m == 0 ? "" : ",");
+                writeEscaped(out, result.metrics[m].first);
+                out << ":" << std::setprecision(4) << result.metrics[m].second;
+            }
+            out << "}";
+        }
+        out << "}";
+    }
+    out << "]}";
+}
+
+void serializeWithWriter(JsonWriter& writer, const std::vector<BenchmarkResult>& results) {
+    writer.beginObject();
+    writer.key("language");
+    writer.value("C++");
+    writer.key("tests");
+    writer.beginArray();
+    for (const auto& result : results) {
+        writer.beginObject();
+        writer.key("test");
+        writer.value(result.test);
+        writer.key("duration_ns");
+        writer.value(result.duration_ns);
+        writer.key("memory_bytes");
+        writer.value(result.memory_bytes);
+        writer.key("operations");
+        writer.value(result.operations);
+        writer.key("ops_per_sec");
+        writer.value(result.ops_per_sec, 2);
+        if (!result.metrics.empty()) {
+            writer.key("metrics");
+            writer.beginObject();
+            for (const auto& metric : result.metrics) {
+                writer.key(metric.first);
+                writer.value(metric.second, 4);
+            }
+            writer.endObject();
+        }
+        writer.endObject();
+    }
+    writer.endArray();
+    writer.endObject();
+}
+
+// パース済みテープを書き戻す（数値は最短表現 / ostream は往復可能な 17 桁）
+size_t writeTape(const JsonDocument& document, size_t index, JsonWriter& writer) {
+    const JsonTapeEntry& entry = document.tape()[index];
+    switch (entry.type) {
+        case JsonType::Null: writer.null(); break;
+        case JsonType::False: writer.value(false); break;
+        case JsonType::True: writer.value(true); break;
+        case JsonType::Number: writer.value(entry.number); break;
+        case JsonType::String: writer.value(document.string(entry)); break;
+        case JsonType::Array:
+            writer.beginArray();
+            for (size_t child = index + 1; child < entry.end;) {
+                child = writeTape(document, child, writer);
+            }
+            writer.endArray();
+            return entry.end;
+        case JsonType::Object:
+            writer.beginObject();
+            for (size_t child = index + 1; child < entry.end;) {
+                writer.key(document.string(document.tape()[child]));
+                child = writeTape(document, child + 1, writer);
+            }
+            writer.endObject();
+            return entry.end;
+    }
+    return index + 1;
+}
+
+size_t streamTape(const JsonDocument& document, size_t index, std::ostream& out) {
+    const JsonTapeEntry& entry = document.tape()[index];
+    switch (entry.type) {
+        case JsonType::Null: out << "null"; break;
+        case JsonType::False: out << "false"; break;
+        case JsonType::True: out << "true"; break;
+        case JsonType::Number: out << std::setprecision(17) << entry.number; break;
+        case JsonType::String: writeEscaped(out, std::string(document.string(entry))); break;
+        case JsonType::Array:
+            out << "[";
+            for (size_t child = index + 1; child < entry.end;) {
+                out << (child == index + 1 ? "" : ",");
+                child = streamTape(document, child, out);
+            }
+            out << "]";
+            return entry.end;
+        case JsonType::Object:
+            out << "{";
+            for (size_t child = index + 1; child < entry.end;) {
+                out << (child == index + 1 ? "" : ",");
+                writeEscaped(out, std::string(document.string(document.tape()[child])));
+                out << ":";
+                child = streamTape(document, child + 1, out);
+            }
+            out << "}";
+            return entry.end;
+    }
+    return index + 1;
+}
+
+std::string samplePath() {
+    const char* configured = std::getenv("BENCHMARK_JSON_SAMPLE");
+    if (configured != nullptr && *configured != '\0') {
+        // 読めないパスは計測中の例外にせず、サンプルのケースごと外す
+        if (!std::ifstream(configured).good()) {
+            std::cerr << "Cannot read BENCHMARK_JSON_SAMPLE '" << configured
+                      << "'; skipping sample benchmarks" << std::endl;
+            return "";
+        }
+        return configured;
+    }
+    for (const char* candidate : {"../comparison_latest.json", "../../comparison_latest.json"}) {
+        if (std::ifstream(candidate).good()) {
+            return candidate;
+        }
+    }
+    return "";
+}
+
+// comparison_latest.json を JSON 配列の要素として目標サイズまで複製する
+std::string scaledSample(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::string sample((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (sample.empty()) {
+        throw std::runtime_error("Could not read JSON sample: " + path);
+    }
+    size_t target = Benchmark::sizesFromEnv("BENCHMARK_JSON_SAMPLE_MB", {32})[0] << 20;
+    std::string scaled;
+    scaled.reserve(target + sample.size() + 2);
+    scaled += "[";
+    do {
+        scaled += scaled.size() == 1 ? "" : ",";
+        scaled += sample;
+    } while (scaled.size() < target);
+    scaled += "]";
+    return scaled;
+}
+
+const std::string& documentFor(const std::string& name) {
+    static std::mutex mutex;
+    static std::map<std::string, std::string> cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = cache.find(name);
+    if (found != cache.end()) {
+        return found->second;
+    }
+    std::cout << "Generating JSON document (" << name << ")..." << std::endl;
+    if (name == kSampleDocument) {
+        return cache[name] = scaledSample(samplePath());
+    }
+    std::ostringstream stream;
+    serializeWithStream(stream, resultsForDocument());
+    return cache[name] = stream.str();
+}
+
+double numberSum(const JsonDocument& document) {
+    double sum = 0.0;
+    for (const auto& entry : document.tape()) {
+        if (entry.type == JsonType::Number) {
+            sum += entry.number;
+        }
+    }
+    return sum;
+}
+
+BenchmarkResult throughputResult(const std::string& name, long long totalNs, long long memory,
+                                 size_t bytesPerRepetition) {
+    long long bytes = static_cast<long long>(bytesPerRepetition) * kRepetitions;
+    double bytesPerSec = bytes / (totalNs / 1e9);
+    BenchmarkResult result(name, totalNs, memory, bytes, bytesPerSec);
+    result.metrics = {
+        {"gb_per_sec", bytesPerSec / 1e9},
+        {"document_mb", bytesPerRepetition / 1e6},
+    };
+    return result;
+}
+
+}
+
+const std::vector<BenchmarkCase>& JsonBenchmark::registeredBenchmarks() {
+    static const std::vector<BenchmarkCase> cases = []() {
+        using Stage1 = JsonDocument::Stage1;
+        std::vector<BenchmarkCase> list = {
+            {"serialize-writer", "json", []() { return benchmarkSerializeResults(true); }},
+            {"serialize-ostream", "json", []() { return benchmarkSerializeResults(false); }},
+            {"parse-simd", "json", []() { return benchmarkParse(kResultsDocument, Stage1::Simd); }},
+            {"parse-scalar", "json", []() { return benchmarkParse(kResultsDocument, Stage1::Scalar); }},
+        };
+        if (!samplePath().empty()) {
+            list.push_back({"parse-sample-simd", "json", []() { return benchmarkParse(kSampleDocument, Stage1::Simd); }});
+            list.push_back({"parse-sample-scalar", "json", []() { return benchmarkParse(kSampleDocument, Stage1::Scalar); }});
+            list.push_back({"serialize-sample-writer", "json", []() { return benchmarkSerializeSample(true); }});
+            list.push_back({"serialize-sample-ostream", "json", []() { return benchmarkSerializeSample(false); }});
+        }
+        return list;
+    }();
+    return cases;
+}
+
+BenchmarkResult JsonBenchmark::benchmarkSerializeResults(bool writer) {
+    const auto& results = resultsForDocument();
+    const std::string& reference = documentFor(kResultsDocument);
+
+    // 出力サイズ分を事前確保し、計測区間では拡張させない
+    JsonWriter jsonWriter(reference.size() + kWriterSlack);
+    std::string output;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < kRepetitions; i++) {
+        if (writer) {
+            jsonWriter.clear();
+            serializeWithWriter(jsonWriter, results);
+        } else {
+            std::ostringstream stream;
+            serializeWithStream(stream, results);
+            output = stream.str();
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    std::string_view produced = writer ? jsonWriter.view() : std::string_view(output);
+    if (produced != reference) {
+        std::cout << "Serialized output differs from the ostream reference" << std::endl;
+    }
+
+    std::string name = std::string("JSON Serialize (") + (writer ? "JsonWriter" : "ostream") + ", results)";
+    return throughputResult(name, duration, static_cast<long long>(produced.size()), produced.size());
+}
+
+BenchmarkResult JsonBenchmark::benchmarkParse(const std::string& documentName, JsonDocument::Stage1 stage1) {
+    const std::string& json = documentFor(documentName);
+
+    JsonDocument document;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < kRepetitions; i++) {
+        document = JsonDocument::parse(json, stage1);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    // SIMD 版はスカラー版とテープを突き合わせる
+    if (stage1 == JsonDocument::Stage1::Simd) {
+        JsonDocument reference = JsonDocument::parse(json, JsonDocument::Stage1::Scalar);
+        if (reference.tape().size() != document.tape().size() || numberSum(reference) != numberSum(document)) {
+            std::cout << "SIMD parse differs from the scalar parse" << std::endl;
+        }
+    }
+
+    bool simd = stage1 == JsonDocument::Stage1::Simd && JsonDocument::simdAvailable();
+    std::string name = std::string("JSON Parse (") + (simd ? "SIMD" : "scalar") + " stage 1, " + documentName + ")";
+    long long memory = static_cast<long long>(document.tape().size() * sizeof(JsonTapeEntry));
+    BenchmarkResult result = throughputResult(name, duration, memory, json.size());
+    result.metrics.push_back({"tape_entries", static_cast<double>(document.tape().size())});
+    return result;
+}
+
+BenchmarkResult JsonBenchmark::benchmarkSerializeSample(bool writer) {
+    const std::string& sample = documentFor(kSampleDocument);
+    JsonDocument document = JsonDocument::parse(sample);
+
+    // 出力は入力とほぼ同じ大きさになるので、その分を事前確保しておく
+    JsonWriter jsonWriter(sample.size() + kWriterSlack);
+    std::string output;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < kRepetitions; i++) {
+        if (writer) {
+            jsonWriter.clear();
+            writeTape(document, 0, jsonWriter);
+        } else {
+            std::ostringstream stream;
+            streamTape(document, 0, stream);
+            output = stream.str();
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    // 書き戻した文書が同じ数値を持つかを確認する
+    std::string_view produced = writer ? jsonWriter.view() : std::string_view(output);
+    JsonDocument reparsed = JsonDocument::parse(produced);
+    if (reparsed.tape().size() != document.tape().size() || numberSum(reparsed) != numberSum(document)) {
+        std::cout << "Re-serialized sample does not round-trip" << std::endl;
+    }
+
+    std::string name = std::string("JSON Serialize (") + (writer ? "JsonWriter" : "ostream") + ", sample)";
+    return throughputResult(name, duration, static_cast<long long>(produced.size()), produced.size());
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "benchmark.h"
+#include "json.h"
+#include <string>
+#include <vector>
+
+// JsonWriter / JsonDocument（json.h）と、Output と同じ ostream + setprecision 方式の比較。
+// 生成した結果ファイル風の文書と、comparison_latest.json を配列に複製して拡大した文書を使う。
+//   BENCHMARK_JSON_ENTRIES    生成文書の結果件数（既定 100000、約 20MB）
+//   BENCHMARK_JSON_SAMPLE_MB  comparison_latest.json を拡大する目標サイズ（既定 32）
+//   BENCHMARK_JSON_SAMPLE     comparison_latest.json のパス（既定はリポジトリ直下を探す。見つからなければ省略）
+class JsonBenchmark {
+public:
+    static const std::vector<BenchmarkCase>& registeredBenchmarks();
+
+private:
+    static BenchmarkResult benchmarkSerializeResults(bool writer);
+    static BenchmarkResult benchmarkParse(const std::string& documentName, JsonDocument::Stage1 stage1);
+    static BenchmarkResult benchmarkSerializeSample(bool writer);
+};
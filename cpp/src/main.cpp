@@ -1,28 +1,230 @@
 #include "benchmark.h"
+#include "contention.h"
+#include "daemon.h"
+#include "external_sort.h"
+#include "graph.h"
+#include "json_benchmark.h"
 #include "output.h"
+#include "paired_benchmark.h"
+#include "profiler.h"
 #include <iostream>
 #include <chrono>
 #include <iomanip>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <utility>
+
+using SuiteCases = const std::vector<BenchmarkCase>& (*)();
+
+// "default" は言語間比較用（benchmark_cpp_*.json）、それ以外は suite_cpp_<name>_*.json
+static const std::map<std::string, SuiteCases>& suites() {
+    static const std::map<std::string, SuiteCases> registry = {
+        {"default", Benchmark::registeredBenchmarks},
+        {"c-paired", PairedBenchmark::registeredBenchmarks},
+        {"external-sort", ExternalSortBenchmark::registeredBenchmarks},
+        {"graph", GraphBenchmark::registeredBenchmarks},
+        {"json", JsonBenchmark::registeredBenchmarks},
+    };
+    return registry;
+}
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--suite <name>] [--benchmark <id>] [--profile]" << std::endl;
+    std::cerr << "       " << program << " [--suite <name>] [--benchmark <id>] --instances <K>"
+              << " [--instance-mode thread|process] [--pin none|cores|smt]" << std::endl;
+    std::cerr << "       " << program << " [--suite <name>] [--benchmark <id,...>] --daemon"
+              << " [--interval <sec>] [--cpu-budget <percent>] [--listen <host:port|unix:path>]" << std::endl;
+    std::cerr << "  --suite    one of:";
+    for (const auto& suite : suites()) {
+        std::cerr << " " << suite.first;
+    }
+    std::cerr << " (default: default)" << std::endl;
+    std::cerr << "  --benchmark      run only the cases with these ids (e.g. prime or prime,hash)" << std::endl;
+    std::cerr << "  --profile        sample each benchmark and write <result>_<id>.folded" << std::endl;
+    std::cerr << "  --instances      run 1, 2, 4, ... K concurrent copies (0 = usable CPUs, max 4096)" << std::endl;
+    std::cerr << "  --instance-mode  run copies as threads (default) or forked processes" << std::endl;
+    std::cerr << "  --pin            pin copies across physical cores or onto SMT siblings" << std::endl;
+    std::cerr << "  --daemon         repeat the cases until SIGTERM and serve Prometheus metrics" << std::endl;
+    std::cerr << "  --interval       seconds between passes in daemon mode (default 60)" << std::endl;
+    std::cerr << "  --cpu-budget     CPU share the daemon may use, in percent of one core (default 5)" << std::endl;
+    std::cerr << "  --listen         metrics address (default 127.0.0.1:9464)" << std::endl;
+}
+
+// 桁数で先に弾くので std::stoi が範囲外で投げることはない
+static bool parseInstanceCount(const std::string& value, int& count) {
+    const int maxInstances = 4096;
+    if (value.empty() || value.size() > 4 || value.find_first_not_of("0123456789") != std::string::npos ||
+        std::stoi(value) > maxInstances) {
+        return false;
+    }
+    count = std::stoi(value);
+    return true;
+}
+
+static bool isNumber(const std::string& value) {
+    return !value.empty() && value.find_first_not_of("0123456789.") == std::string::npos &&
+        value.find_first_of("0123456789") != std::string::npos && std::stod(value) > 0;
+}
+
+static std::vector<std::string> splitIds(const std::string& list) {
+    std::vector<std::string> ids;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t comma = std::min(list.find(',', start), list.size());
+        if (comma > start) {
+            ids.push_back(list.substr(start, comma - start));
+        }
+        start = comma + 1;
+    }
+    return ids;
+}
+
+int main(int argc, char* argv[]) {
+    bool profile = false;
+    std::string suite = "default";
+    std::string benchmarkId;
+    bool contention = false;
+    ContentionOptions contentionOptions;
+    bool daemon = false;
+    DaemonOptions daemonOptions;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        std::string value = i + 1 < argc ? argv[i + 1] : "";
+        if (arg == "--profile") {
+            profile = true;
+        } else if (arg == "--suite" && suites().count(value) > 0) {
+            suite = argv[++i];
+        } else if (arg == "--benchmark" && !value.empty()) {
+            benchmarkId = argv[++i];
+        } else if (arg == "--instances" && parseInstanceCount(value, contentionOptions.maxInstances)) {
+            contention = true;
+            i++;
+        } else if (arg == "--instance-mode" && (value == "thread" || value == "process")) {
+            contentionOptions.mode = value == "process" ? InstanceMode::Process : InstanceMode::Thread;
+            i++;
+        } else if (arg == "--pin" && (value == "none" || value == "cores" || value == "smt")) {
+            contentionOptions.pin = value == "cores" ? PinPolicy::Cores
+                : value == "smt" ? PinPolicy::Smt : PinPolicy::None;
+            i++;
+        } else if (arg == "--daemon") {
+            daemon = true;
+        } else if (arg == "--interval" && isNumber(value)) {
+            daemonOptions.intervalSeconds = std::stod(argv[++i]);
+        } else if (arg == "--cpu-budget" && isNumber(value) && std::stod(value) <= 100) {
+            daemonOptions.cpuBudget = std::stod(argv[++i]) / 100;
+        } else if (arg == "--listen" && !value.empty()) {
+            daemonOptions.listen = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (profile && !Profiler::isSupported()) {
+        std::cerr << "Profiling is not supported on this platform" << std::endl;
+        return 1;
+    }
+#ifndef BENCHMARK_FRAME_POINTERS
+    if (profile) {
+        std::cerr << "Warning: built without frame pointers; profiled stacks may stop at the sampled function "
+                  << "(rebuild with -DBENCHMARK_FRAME_POINTERS=ON)" << std::endl;
+    }
+#endif
+    if (profile && contention) {
+        std::cerr << "--profile cannot be combined with --instances" << std::endl;
+        return 1;
+    }
+    if (daemon && (profile || contention)) {
+        std::cerr << "--daemon cannot be combined with --profile or --instances" << std::endl;
+        return 1;
+    }
+    if (contention && contentionOptions.maxInstances == 0) {
+        contentionOptions.maxInstances = Contention::usableCpus();
+    }
+
+    std::vector<std::string> benchmarkIds = splitIds(benchmarkId);
+    std::vector<BenchmarkCase> cases;
+    for (const auto& benchmarkCase : suites().at(suite)()) {
+        if (benchmarkIds.empty() ||
+            std::find(benchmarkIds.begin(), benchmarkIds.end(), benchmarkCase.id) != benchmarkIds.end()) {
+            cases.push_back(benchmarkCase);
+        }
+    }
+    if (cases.empty() || (!benchmarkIds.empty() && cases.size() != benchmarkIds.size())) {
+        if (benchmarkId.empty()) {
+            std::cerr << "Suite " << suite << " has no benchmarks with the current settings" << std::endl;
+        } else {
+            std::cerr << "No benchmark '" << benchmarkId << "' in suite " << suite << std::endl;
+        }
+        return 1;
+    }
+
+    // デーモンは結果ファイルを書かず、/metrics でだけ公開する
+    if (daemon) {
+        try {
+            return Daemon::run(cases, daemonOptions);
+        } catch (const std::exception& e) {
+            std::cerr << "Error running daemon: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    // 比較用のファイル名は全ケースを通常実行したときだけ使う
+    std::string outputSuite = suite == "default" ? "" : suite;
+    if (contention) {
+        outputSuite = suite + "-contention";
+    } else if (!benchmarkId.empty()) {
+        outputSuite = suite + "-" + benchmarkId;
+        std::replace(outputSuite.begin(), outputSuite.end(), ',', '+');
+    }
+
+    // プロファイル時は各ベンチマーク本体の実行中だけサンプリングする
+    std::vector<std::pair<std::string, ProfileReport>> profiles;
+    Benchmark::Runner runner;
+    if (profile) {
+        runner = [&profiles](const BenchmarkCase& benchmarkCase) {
+            Profiler::start();
+            BenchmarkResult result = benchmarkCase.run();
+            ProfileReport report = Profiler::stop();
+            result.hotFunctions = report.hotFunctions;
+            result.metrics.push_back({"profile_samples", static_cast<double>(report.samples)});
+            result.metrics.push_back({"profile_dropped", static_cast<double>(report.dropped)});
+            profiles.emplace_back(benchmarkCase.id, std::move(report));
+            return result;
+        };
+    }
 
-int main() {
     auto startTime = std::chrono::high_resolution_clock::now();
-    
-    auto results = Benchmark::runAllBenchmarks();
-    
+
+    // 一時ファイルの作成失敗などはベンチマーク本体から例外で届く
+    std::vector<BenchmarkResult> results;
+    try {
+        results = contention
+            ? Contention::run(cases, contentionOptions)
+            : Benchmark::runBenchmarks(cases, runner);
+    } catch (const std::exception& e) {
+        std::cerr << "Error running benchmarks: " << e.what() << std::endl;
+        return 1;
+    }
+
     auto endTime = std::chrono::high_resolution_clock::now();
     auto totalDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime);
     double totalTime = totalDuration.count() / 1e9;
-    
+
     Output::printResults(results);
-    
+
     try {
-        Output::saveResultsToJSON(results, totalTime);
+        std::string filename = Output::saveResultsToJSON(results, totalTime, outputSuite);
+        for (const auto& profileEntry : profiles) {
+            Output::saveFoldedStacks(filename, profileEntry.first, profileEntry.second.foldedStacks);
+        }
     } catch (const std::exception& e) {
         std::cerr << "Error saving results: " << e.what() << std::endl;
         return 1;
     }
-    
+
     std::cout << "Total execution time: " << std::fixed << std::setprecision(3) << totalTime << " seconds" << std::endl;
-    
+
     return 0;
-}
\ No newline at end of file
+}
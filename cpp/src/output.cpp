@@ -6,6 +6,29 @@
 #include <sstream>
 #include <thread>
 
+namespace {
+
+const char* cppStandardName() {
+#if __cplusplus >= 202002L
+    return "C++20";
+#else
+    return "C++17";
+#endif
+}
+
+std::string escapeJSON(const std::string& value) {
+    std::string escaped;
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+}
+
 void Output::printResults(const std::vector<BenchmarkResult>& results) {
     std::cout << "\n=== BENCHMARK RESULTS ===" << std::endl;
     for (const auto& result : results) {
@@ -14,11 +37,15 @@ void Output::printResults(const std::vector<BenchmarkResult>& results) {
         std::cout << "  Memory: " << result.memory_bytes << " bytes" << std::endl;
         std::cout << "  Operations: " << result.operations << std::endl;
         std::cout << "  Ops/sec: " << std::fixed << std::setprecision(2) << result.ops_per_sec << std::endl;
+        for (const auto& metric : result.metrics) {
+            std::cout << "  " << metric.first << ": " << std::fixed << std::setprecision(2) << metric.second << std::endl;
+        }
         std::cout << std::endl;
     }
 }
 
-void Output::saveResultsToJSON(const std::vector<BenchmarkResult>& results, double totalTime) {
+std::string Output::saveResultsToJSON(const std::vector<BenchmarkResult>& results, double totalTime,
+                                      const std::string& suite) {
     // 現在時刻取得
     auto now = std::chrono::system_clock::now();
     auto time_t = std::chrono::system_clock::to_time_t(now);
@@ -29,7 +56,10 @@ void Output::saveResultsToJSON(const std::vector<BenchmarkResult>& results, doub
     timestampStream << std::put_time(&tm, "%Y%m%d_%H%M%S");
     std::string timestamp = timestampStream.str();
     
-    std::string filename = "../benchmark_cpp_" + timestamp + ".json";
+    // 追加スイートは言語間比較（benchmark_*.json）に混ざらないよう別名で保存
+    std::string filename = suite.empty()
+        ? "../benchmark_cpp_" + timestamp + ".json"
+        : "../suite_cpp_" + suite + "_" + timestamp + ".json";
     std::ofstream file(filename);
     
     if (!file.is_open()) {
@@ -38,6 +68,9 @@ void Output::saveResultsToJSON(const std::vector<BenchmarkResult>& results, doub
     
     file << "{\n";
     file << "  \"language\": \"cpp\",\n";
+    if (!suite.empty()) {
+        file << "  \"suite\": \"" << suite << "\",\n";
+    }
     
     // タイムスタンプ（ISO形式）
     std::ostringstream isoStream;
@@ -45,7 +78,7 @@ void Output::saveResultsToJSON(const std::vector<BenchmarkResult>& results, doub
     file << "  \"timestamp\": \"" << isoStream.str() << "\",\n";
     
     file << "  \"compiler\": \"" << __VERSION__ << "\",\n";
-    file << "  \"cpp_standard\": \"C++17\",\n";
+    file << "  \"cpp_standard\": \"" << cppStandardName() << "\",\n";
     file << "  \"system\": {\n";
     file << "    \"os\": \"" << 
 #ifdef __APPLE__
@@ -80,7 +113,26 @@ void Output::saveResultsToJSON(const std::vector<BenchmarkResult>& results, doub
         file << "      \"duration_ns\": " << result.duration_ns << ",\n";
         file << "      \"memory_bytes\": " << result.memory_bytes << ",\n";
         file << "      \"operations\": " << result.operations << ",\n";
-        file << "      \"ops_per_sec\": " << std::fixed << std::setprecision(2) << result.ops_per_sec << "\n";
+        file << "      \"ops_per_sec\": " << std::fixed << std::setprecision(2) << result.ops_per_sec;
+        if (!result.metrics.empty()) {
+            file << ",\n      \"metrics\": {";
+            for (size_t m = 0; m < result.metrics.size(); m++) {
+                file << (m == 0 ? "" : ", ") << "\"" << result.metrics[m].first << "\": "
+                     << std::setprecision(4) << result.metrics[m].second;
+            }
+            file << "}";
+        }
+        if (!result.hotFunctions.empty()) {
+            file << ",\n      \"hot_functions\": [";
+            for (size_t h = 0; h < result.hotFunctions.size(); h++) {
+                const auto& hot = result.hotFunctions[h];
+                file << (h == 0 ? "" : ", ") << "{\"function\": \"" << escapeJSON(hot.function)
+                     << "\", \"samples\": " << hot.samples
+                     << ", \"percent\": " << std::setprecision(2) << hot.percent << "}";
+            }
+            file << "]";
+        }
+        file << "\n";
         file << "    }";
         if (i < results.size() - 1) {
             file << ",";
@@ -94,4 +146,23 @@ void Output::saveResultsToJSON(const std::vector<BenchmarkResult>& results, doub
     
     file.close();
     std::cout << "Results saved to: " << filename << std::endl;
+    return filename;
+}
+
+void Output::saveFoldedStacks(const std::string& jsonFilename, const std::string& id,
+                              const std::map<std::string, long long>& foldedStacks) {
+    std::string base = jsonFilename.substr(0, jsonFilename.rfind(".json"));
+    std::string filename = base + "_" + id + ".folded";
+    std::ofstream file(filename);
+    
+    if (!file.is_open()) {
+        throw std::runtime_error("Error writing file: Could not open " + filename);
+    }
+    
+    for (const auto& stack : foldedStacks) {
+        file << stack.first << " " << stack.second << "\n";
+    }
+    
+    file.close();
+    std::cout << "Profile saved to: " << filename << std::endl;
 }
\ No newline at end of file
@@ -1,10 +1,17 @@
 #pragma once
 
 #include "benchmark.h"
+#include <map>
+#include <string>
 #include <vector>
 
 class Output {
 public:
     static void printResults(const std::vector<BenchmarkResult>& results);
-    static void saveResultsToJSON(const std::vector<BenchmarkResult>& results, double totalTime);
+    // 保存したファイル名を返す
+    static std::string saveResultsToJSON(const std::vector<BenchmarkResult>& results, double totalTime,
+                                         const std::string& suite = "");
+    // JSONと同じ場所に <JSON名>_<id>.folded を書き出す
+    static void saveFoldedStacks(const std::string& jsonFilename, const std::string& id,
+                                 const std::map<std::string, long long>& foldedStacks);
 };
\ No newline at end of file
@@ -0,0 +1,300 @@
+#include "paired_benchmark.h"
+#include "kernels.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace {
+
+const int kRuns = 5;
+
+long long timeKernel(const std::function<void()>& kernel) {
+    auto start = std::chrono::high_resolution_clock::now();
+    kernel();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+long long median(std::vector<long long> samples) {
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+// 実行順の偏りを避けるため、C→C++ と C++→C を交互に繰り返す。
+// reset は計測外で毎回呼ばれる（ソート前データの復元など）
+BenchmarkResult runPaired(const std::string& name, long long operations,
+                          const std::function<void()>& cKernel,
+                          const std::function<void()>& cppKernel,
+                          const std::function<void()>& reset = nullptr) {
+    std::vector<long long> cSamples;
+    std::vector<long long> cppSamples;
+    for (int run = 0; run < kRuns; run++) {
+        for (int side = 0; side < 2; side++) {
+            bool cTurn = (run + side) % 2 == 0;
+            if (reset) {
+                reset();
+            }
+            (cTurn ? cSamples : cppSamples).push_back(timeKernel(cTurn ? cKernel : cppKernel));
+        }
+    }
+
+    long long cMedian = median(cSamples);
+    long long cppMedian = median(cppSamples);
+    BenchmarkResult result(name + " [C vs C++]", cppMedian, 0, operations, operations / (cppMedian / 1e9));
+    result.metrics = {
+        {"c_median_ns", static_cast<double>(cMedian)},
+        {"cpp_median_ns", static_cast<double>(cppMedian)},
+        {"c_min_ns", static_cast<double>(*std::min_element(cSamples.begin(), cSamples.end()))},
+        {"cpp_min_ns", static_cast<double>(*std::min_element(cppSamples.begin(), cppSamples.end()))},
+        {"c_cpp_ratio", static_cast<double>(cMedian) / cppMedian},
+        {"runs", static_cast<double>(kRuns)},
+    };
+    return result;
+}
+
+void checkSame(long long cValue, long long cppValue) {
+    if (cValue != cppValue) {
+        std::cout << "Kernel results differ: C=" << cValue << " C++=" << cppValue << std::endl;
+    }
+}
+
+// 以下C++側の処理本体（benchmark.cpp と同じ書き方）
+bool cppIsPrime(int n) {
+    if (n < 2) return false;
+    for (int i = 2; i <= std::sqrt(n); i++) {
+        if (n % i == 0) return false;
+    }
+    return true;
+}
+
+uint32_t cppHashRepeated(const std::string& data, int iterations) {
+    uint32_t hashSum = 0;
+    for (int i = 0; i < iterations; i++) {
+        uint32_t hash = 5381;
+        for (unsigned char c : data) {
+            hash = ((hash << 5) + hash) + c;
+        }
+        hashSum += hash;
+    }
+    return hashSum;
+}
+
+}
+
+const std::vector<BenchmarkCase>& PairedBenchmark::registeredBenchmarks() {
+    static const std::vector<BenchmarkCase> cases = {
+        {"prime", "paired CPU-intensive", benchmarkPrimeNumbers},
+        {"matrix", "paired CPU-intensive", benchmarkMatrixMultiplication},
+        {"hash", "paired CPU-intensive", benchmarkHashComputing},
+        {"math", "paired CPU-intensive", benchmarkMathOperations},
+        {"sort", "paired memory-intensive", benchmarkLargeArraySort},
+        {"alloc", "paired memory-intensive", benchmarkMemoryAllocation},
+        {"string", "paired memory-intensive", benchmarkStringConcatenation},
+    };
+    return cases;
+}
+
+BenchmarkResult PairedBenchmark::benchmarkPrimeNumbers() {
+    const int limit = 100000;
+    long long cCount = 0;
+    long long cppCount = 0;
+
+    auto result = runPaired("Prime Numbers (up to 100k)", limit,
+        [&]() { cCount = count_primes(limit); },
+        [&]() {
+            int count = 0;
+            for (int i = 2; i <= limit; i++) {
+                if (cppIsPrime(i)) {
+                    count++;
+                }
+            }
+            cppCount = count;
+        });
+
+    checkSame(cCount, cppCount);
+    // 既定スイートと同じく見つかった素数の個数を操作数とする
+    result.operations = cppCount;
+    result.ops_per_sec = cppCount / (result.duration_ns / 1e9);
+    return result;
+}
+
+BenchmarkResult PairedBenchmark::benchmarkMatrixMultiplication() {
+    const int size = 500;
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> dis(0.0, 1.0);
+
+    std::vector<std::vector<double>> a(size, std::vector<double>(size));
+    std::vector<std::vector<double>> b(size, std::vector<double>(size));
+    std::vector<std::vector<double>> c(size, std::vector<double>(size, 0.0));
+    for (int i = 0; i < size; i++) {
+        for (int j = 0; j < size; j++) {
+            a[i][j] = dis(gen);
+            b[i][j] = dis(gen);
+        }
+    }
+
+    // C版は行ポインタ配列（double**）を受け取る
+    std::vector<double*> aRows, bRows, cRows;
+    for (int i = 0; i < size; i++) {
+        aRows.push_back(a[i].data());
+        bRows.push_back(b[i].data());
+        cRows.push_back(c[i].data());
+    }
+
+    double cTrace = 0.0;
+    double cppTrace = 0.0;
+    auto trace = [&]() {
+        double sum = 0.0;
+        for (int i = 0; i < size; i++) {
+            sum += c[i][i];
+        }
+        return sum;
+    };
+
+    long long operations = static_cast<long long>(size) * size * size;
+    auto result = runPaired("Matrix Multiplication (500x500)", operations,
+        [&]() {
+            multiply_matrices(aRows.data(), bRows.data(), cRows.data(), size);
+            cTrace = trace();
+        },
+        [&]() {
+            for (int i = 0; i < size; i++) {
+                for (int j = 0; j < size; j++) {
+                    for (int k = 0; k < size; k++) {
+                        c[i][j] += a[i][k] * b[k][j];
+                    }
+                }
+            }
+            cppTrace = trace();
+        },
+        [&]() {
+            for (auto& row : c) {
+                std::fill(row.begin(), row.end(), 0.0);
+            }
+        });
+
+    if (std::abs(cTrace - cppTrace) > 1e-6 * std::abs(cppTrace)) {
+        std::cout << "Kernel results differ: C=" << cTrace << " C++=" << cppTrace << std::endl;
+    }
+    return result;
+}
+
+BenchmarkResult PairedBenchmark::benchmarkHashComputing() {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dis(0, 255);
+    std::string data(1024, '\0');
+    for (auto& byte : data) {
+        byte = static_cast<char>(dis(gen));
+    }
+
+    // 両言語とも djb2 で同じ 1KB を繰り返しハッシュする
+    const int iterations = 50000;
+    long long cHash = 0;
+    long long cppHash = 0;
+
+    auto result = runPaired("Hash Computing (50k iterations)", iterations,
+        [&]() { cHash = hash_repeated(data.data(), data.size(), iterations); },
+        [&]() { cppHash = cppHashRepeated(data, iterations); });
+
+    checkSame(cHash, cppHash);
+    return result;
+}
+
+BenchmarkResult PairedBenchmark::benchmarkMathOperations() {
+    const int iterations = 10000000;
+    double cValue = 0.0;
+    double cppValue = 0.0;
+
+    auto result = runPaired("Math Operations (10M iterations)", iterations,
+        [&]() { cValue = math_operations(iterations); },
+        [&]() {
+            double value = 0.0;
+            for (int i = 0; i < iterations; i++) {
+                double x = static_cast<double>(i);
+                value += std::sin(x) * std::cos(x) * std::sqrt(x + 1);
+            }
+            cppValue = value;
+        });
+
+    if (std::isnan(cValue) || std::isnan(cppValue)) {
+        std::cout << "Unexpected NaN result" << std::endl;
+    }
+    return result;
+}
+
+BenchmarkResult PairedBenchmark::benchmarkLargeArraySort() {
+    const int size = 1000000;
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dis(0, 1000000);
+    std::vector<int> input(size);
+    for (int& val : input) {
+        val = dis(gen);
+    }
+
+    std::vector<int> data;
+    long long cMedian = 0;
+    long long cppMedian = 0;
+
+    auto result = runPaired("Large Array Sort (1M elements)", size,
+        [&]() {
+            sort_ints(data.data(), data.size());
+            cMedian = data[size / 2];
+        },
+        [&]() {
+            std::sort(data.begin(), data.end());
+            cppMedian = data[size / 2];
+        },
+        [&]() { data = input; });
+
+    checkSame(cMedian, cppMedian);
+    return result;
+}
+
+BenchmarkResult PairedBenchmark::benchmarkMemoryAllocation() {
+    const int allocations = 100000;
+    long long cChecksum = 0;
+    long long cppChecksum = 0;
+
+    auto result = runPaired("Memory Allocation (100k x 1KB)", allocations,
+        [&]() { cChecksum = allocate_arrays(allocations); },
+        [&]() {
+            std::vector<std::vector<int>> arrays;
+            arrays.reserve(allocations);
+            long long checksum = 0;
+            for (int i = 0; i < allocations; i++) {
+                arrays.emplace_back(256, i % 256);
+            }
+            for (const auto& array : arrays) {
+                checksum += array[255];
+            }
+            cppChecksum = checksum;
+        });
+
+    checkSame(cChecksum, cppChecksum);
+    return result;
+}
+
+BenchmarkResult PairedBenchmark::benchmarkStringConcatenation() {
+    const int iterations = 50000;
+    long long cLength = 0;
+    long long cppLength = 0;
+
+    auto result = runPaired("String Concatenation (50k iterations)", iterations,
+        [&]() { cLength = static_cast<long long>(concatenate_strings(iterations)); },
+        [&]() {
+            std::ostringstream stream;
+            for (int i = 0; i < iterations; i++) {
+                stream << "iteration_" << i << "_";
+            }
+            cppLength = static_cast<long long>(stream.tellp());
+        });
+
+    checkSame(cLength, cppLength);
+    return result;
+}
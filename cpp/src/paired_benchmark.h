@@ -0,0 +1,20 @@
+#pragma once
+
+#include "benchmark.h"
+#include <vector>
+
+// C版（c/src/kernels.c）とC++版の処理本体を同一プロセス・同一入力・同一タイマーで交互に計測する。
+// duration_ns / ops_per_sec はC++側の中央値、両言語の値は metrics に入る
+class PairedBenchmark {
+public:
+    static const std::vector<BenchmarkCase>& registeredBenchmarks();
+
+private:
+    static BenchmarkResult benchmarkPrimeNumbers();
+    static BenchmarkResult benchmarkMatrixMultiplication();
+    static BenchmarkResult benchmarkHashComputing();
+    static BenchmarkResult benchmarkMathOperations();
+    static BenchmarkResult benchmarkLargeArraySort();
+    static BenchmarkResult benchmarkMemoryAllocation();
+    static BenchmarkResult benchmarkStringConcatenation();
+};
\ No newline at end of file
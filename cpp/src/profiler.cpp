@@ -0,0 +1,345 @@
+#include "profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <unordered_map>
+
+#if (defined(__linux__) || defined(__APPLE__)) && (defined(__x86_64__) || defined(__aarch64__))
+#define PROFILER_SUPPORTED 1
+#include <csignal>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <sys/time.h>
+#ifdef __APPLE__
+#include <sys/ucontext.h>
+#else
+#include <elf.h>
+#include <link.h>
+#include <ucontext.h>
+#endif
+#endif
+
+namespace {
+
+constexpr int kMaxDepth = 64;
+constexpr size_t kMaxSamples = 16384;
+constexpr long kSampleIntervalUs = 1000;
+
+struct Sample {
+    int depth;
+    uintptr_t pcs[kMaxDepth];
+};
+
+// シグナルハンドラから触るため、バッファは使い回して解放しない
+std::unique_ptr<Sample[]> gSamples;
+std::atomic<bool> gActive{false};
+std::atomic<size_t> gNextSample{0};
+uintptr_t gStackLow = 0;
+uintptr_t gStackHigh = 0;
+
+#ifdef PROFILER_SUPPORTED
+
+void readRegisters(void* context, uintptr_t& pc, uintptr_t& fp, uintptr_t& sp) {
+    auto* uc = static_cast<ucontext_t*>(context);
+#if defined(__linux__) && defined(__x86_64__)
+    pc = static_cast<uintptr_t>(uc->uc_mcontext.gregs[REG_RIP]);
+    fp = static_cast<uintptr_t>(uc->uc_mcontext.gregs[REG_RBP]);
+    sp = static_cast<uintptr_t>(uc->uc_mcontext.gregs[REG_RSP]);
+#elif defined(__linux__) && defined(__aarch64__)
+    pc = uc->uc_mcontext.pc;
+    fp = uc->uc_mcontext.regs[29];
+    sp = uc->uc_mcontext.sp;
+#elif defined(__APPLE__) && defined(__x86_64__)
+    pc = uc->uc_mcontext->__ss.__rip;
+    fp = uc->uc_mcontext->__ss.__rbp;
+    sp = uc->uc_mcontext->__ss.__rsp;
+#else
+    pc = uc->uc_mcontext->__ss.__pc;
+    fp = uc->uc_mcontext->__ss.__fp;
+    sp = uc->uc_mcontext->__ss.__sp;
+#endif
+}
+
+void onSample(int, siginfo_t*, void* context) {
+    if (!gActive.load(std::memory_order_relaxed)) {
+        return;
+    }
+    size_t index = gNextSample.fetch_add(1, std::memory_order_relaxed);
+    if (index >= kMaxSamples) {
+        return;
+    }
+
+    Sample& sample = gSamples[index];
+    uintptr_t pc = 0, fp = 0, sp = 0;
+    readRegisters(context, pc, fp, sp);
+
+    int depth = 0;
+    sample.pcs[depth++] = pc;
+    // スタック外・逆向きのフレームは辿らない（フレームポインタ省略時の安全策）
+    while (depth < kMaxDepth && fp >= sp && fp % sizeof(uintptr_t) == 0 &&
+           fp >= gStackLow && fp + 2 * sizeof(uintptr_t) <= gStackHigh) {
+        auto* frame = reinterpret_cast<uintptr_t*>(fp);
+        uintptr_t next = frame[0];
+        uintptr_t ret = frame[1];
+        if (ret == 0) {
+            break;
+        }
+        sample.pcs[depth++] = ret;
+        if (next <= fp) {
+            break;
+        }
+        fp = next;
+    }
+    sample.depth = depth;
+}
+
+void loadStackBounds() {
+    pthread_t self = pthread_self();
+#ifdef __APPLE__
+    gStackHigh = reinterpret_cast<uintptr_t>(pthread_get_stackaddr_np(self));
+    gStackLow = gStackHigh - pthread_get_stacksize_np(self);
+#else
+    pthread_attr_t attr;
+    void* addr = nullptr;
+    size_t size = 0;
+    if (pthread_getattr_np(self, &attr) == 0) {
+        pthread_attr_getstack(&attr, &addr, &size);
+        pthread_attr_destroy(&attr);
+    }
+    gStackLow = reinterpret_cast<uintptr_t>(addr);
+    gStackHigh = gStackLow + size;
+#endif
+}
+
+std::string demangle(const char* symbol) {
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(symbol, nullptr, nullptr, &status);
+    std::string name = (status == 0 && demangled != nullptr) ? demangled : symbol;
+    std::free(demangled);
+    // ';' は folded 形式の区切り文字
+    std::replace(name.begin(), name.end(), ';', ':');
+    return name;
+}
+
+#ifdef __linux__
+
+// ELF の .symtab から引く関数シンボル表。dladdr は動的シンボルしか見ないため、
+// 無名名前空間や static の関数はこちらでないと名前が付かない
+class SymbolTable {
+public:
+    explicit SymbolTable(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::vector<char> image((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (image.size() < sizeof(ElfW(Ehdr)) || std::memcmp(image.data(), ELFMAG, SELFMAG) != 0) {
+            return;
+        }
+        ElfW(Ehdr) header;
+        std::memcpy(&header, image.data(), sizeof(header));
+        relative_ = header.e_type == ET_DYN;
+        if (header.e_shentsize != sizeof(ElfW(Shdr)) ||
+            header.e_shoff + static_cast<size_t>(header.e_shnum) * sizeof(ElfW(Shdr)) > image.size()) {
+            return;
+        }
+        std::vector<ElfW(Shdr)> sections(header.e_shnum);
+        std::memcpy(sections.data(), image.data() + header.e_shoff, sections.size() * sizeof(ElfW(Shdr)));
+
+        for (const ElfW(Shdr)& section : sections) {
+            if (section.sh_type != SHT_SYMTAB || section.sh_link >= sections.size()) {
+                continue;
+            }
+            const ElfW(Shdr)& strtab = sections[section.sh_link];
+            if (section.sh_offset + section.sh_size > image.size() ||
+                strtab.sh_offset + strtab.sh_size > image.size()) {
+                continue;
+            }
+            size_t count = section.sh_size / sizeof(ElfW(Sym));
+            for (size_t i = 0; i < count; i++) {
+                ElfW(Sym) symbol;
+                std::memcpy(&symbol, image.data() + section.sh_offset + i * sizeof(ElfW(Sym)), sizeof(symbol));
+                if (ELF64_ST_TYPE(symbol.st_info) != STT_FUNC || symbol.st_value == 0 ||
+                    symbol.st_shndx == SHN_UNDEF || symbol.st_name >= strtab.sh_size) {
+                    continue;
+                }
+                const char* name = image.data() + strtab.sh_offset + symbol.st_name;
+                size_t length = strnlen(name, strtab.sh_size - symbol.st_name);
+                symbols_.push_back({symbol.st_value, symbol.st_size, std::string(name, length)});
+            }
+        }
+        std::sort(symbols_.begin(), symbols_.end(), [](const Symbol& a, const Symbol& b) {
+            return a.address < b.address;
+        });
+    }
+
+    // 見つからなければ nullptr
+    const std::string* find(uintptr_t pc, uintptr_t base) const {
+        uintptr_t address = relative_ ? pc - base : pc;
+        auto it = std::upper_bound(symbols_.begin(), symbols_.end(), address, [](uintptr_t value, const Symbol& symbol) {
+            return value < symbol.address;
+        });
+        if (it == symbols_.begin()) {
+            return nullptr;
+        }
+        --it;
+        if (it->size != 0 && address >= it->address + it->size) {
+            return nullptr;
+        }
+        return &it->name;
+    }
+
+private:
+    struct Symbol {
+        uintptr_t address;
+        uintptr_t size;
+        std::string name;
+    };
+
+    bool relative_ = false;
+    std::vector<Symbol> symbols_;
+};
+
+const std::string* findStaticSymbol(uintptr_t pc, const Dl_info& info) {
+    static std::map<uintptr_t, std::unique_ptr<SymbolTable>> tables;
+    uintptr_t base = reinterpret_cast<uintptr_t>(info.dli_fbase);
+    auto it = tables.find(base);
+    if (it == tables.end()) {
+        // 実行ファイル自身は dli_fname が argv[0] になるので /proc/self/exe から読む
+        Dl_info self;
+        std::string path = info.dli_fname != nullptr ? info.dli_fname : "";
+        if (dladdr(reinterpret_cast<void*>(&findStaticSymbol), &self) != 0 && self.dli_fbase == info.dli_fbase) {
+            path = "/proc/self/exe";
+        }
+        it = tables.emplace(base, std::make_unique<SymbolTable>(path)).first;
+    }
+    return it->second->find(pc, base);
+}
+
+#endif
+
+std::string symbolize(uintptr_t pc) {
+    char buffer[64];
+    Dl_info info;
+    if (dladdr(reinterpret_cast<void*>(pc), &info) != 0) {
+#ifdef __linux__
+        if (const std::string* name = findStaticSymbol(pc, info)) {
+            return demangle(name->c_str());
+        }
+#endif
+        if (info.dli_sname != nullptr) {
+            return demangle(info.dli_sname);
+        }
+        if (info.dli_fname != nullptr) {
+            std::string module = info.dli_fname;
+            module = module.substr(module.find_last_of('/') + 1);
+            std::snprintf(buffer, sizeof(buffer), "+0x%lx",
+                          static_cast<unsigned long>(pc - reinterpret_cast<uintptr_t>(info.dli_fbase)));
+            return module + buffer;
+        }
+    }
+    std::snprintf(buffer, sizeof(buffer), "0x%lx", static_cast<unsigned long>(pc));
+    return buffer;
+}
+
+#endif
+
+}
+
+bool Profiler::isSupported() {
+#ifdef PROFILER_SUPPORTED
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Profiler::start() {
+#ifdef PROFILER_SUPPORTED
+    static bool installed = false;
+    if (!gSamples) {
+        gSamples.reset(new Sample[kMaxSamples]);
+    }
+    for (size_t i = 0; i < kMaxSamples; i++) {
+        gSamples[i].depth = 0;
+    }
+    loadStackBounds();
+    gNextSample.store(0);
+
+    // 停止後に届いた SIGPROF で終了しないよう、ハンドラは入れたままにする
+    if (!installed) {
+        struct sigaction action = {};
+        action.sa_sigaction = onSample;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGPROF, &action, nullptr);
+        installed = true;
+    }
+    gActive.store(true);
+
+    struct itimerval timer = {};
+    timer.it_interval.tv_usec = kSampleIntervalUs;
+    timer.it_value.tv_usec = kSampleIntervalUs;
+    setitimer(ITIMER_PROF, &timer, nullptr);
+#endif
+}
+
+ProfileReport Profiler::stop(size_t topN) {
+    ProfileReport report;
+#ifdef PROFILER_SUPPORTED
+    struct itimerval disarm = {};
+    setitimer(ITIMER_PROF, &disarm, nullptr);
+    gActive.store(false);
+
+    size_t taken = gNextSample.load();
+    size_t count = std::min(taken, kMaxSamples);
+    report.dropped = static_cast<long long>(taken - count);
+
+    std::unordered_map<uintptr_t, std::string> names;
+    std::map<std::string, long long> selfSamples;
+    for (size_t i = 0; i < count; i++) {
+        const Sample& sample = gSamples[i];
+        if (sample.depth == 0) {
+            continue;
+        }
+        report.samples++;
+
+        // 戻りアドレスは call の次を指すので 1 引いて呼び出し元の行に寄せる
+        std::string stack;
+        for (int d = sample.depth - 1; d >= 0; d--) {
+            uintptr_t pc = d == 0 ? sample.pcs[0] : sample.pcs[d] - 1;
+            auto it = names.find(pc);
+            if (it == names.end()) {
+                it = names.emplace(pc, symbolize(pc)).first;
+            }
+            if (!stack.empty()) {
+                stack += ';';
+            }
+            stack += it->second;
+            if (d == 0) {
+                selfSamples[it->second]++;
+            }
+        }
+        report.foldedStacks[stack]++;
+    }
+
+    std::vector<std::pair<std::string, long long>> ranked(selfSamples.begin(), selfSamples.end());
+    std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) {
+        return a.second > b.second;
+    });
+    for (size_t i = 0; i < ranked.size() && i < topN; i++) {
+        report.hotFunctions.push_back({
+            ranked[i].first,
+            ranked[i].second,
+            100.0 * ranked[i].second / report.samples,
+        });
+    }
+#else
+    (void)topN;
+#endif
+    return report;
+}
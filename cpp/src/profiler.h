@@ -0,0 +1,22 @@
+#pragma once
+
+#include "benchmark.h"
+#include <map>
+#include <string>
+#include <vector>
+
+struct ProfileReport {
+    // "root;...;leaf" → サンプル数（flamegraph.pl にそのまま渡せる形式）
+    std::map<std::string, long long> foldedStacks;
+    std::vector<HotFunction> hotFunctions;
+    long long samples = 0;
+    long long dropped = 0;
+};
+
+// SIGPROF/setitimer によるサンプリングプロファイラ（フレームポインタで巻き戻す）
+class Profiler {
+public:
+    static bool isSupported();
+    static void start();
+    static ProfileReport stop(size_t topN = 5);
+};